@@ -30,7 +30,7 @@ void App2048::handleInput(InputService& input) {
 void App2048::tick(unsigned long) {
 }
 
-void App2048::render(DisplayService& display) {
+void App2048::render(DisplayService& display, float) {
   const int cell = 15;
   const int x0 = 2;
   const int y0 = 2;
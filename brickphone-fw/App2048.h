@@ -9,7 +9,8 @@ public:
   void onEnter() override;
   void handleInput(InputService& input) override;
   void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  void render(DisplayService& display, float alpha) override;
+  bool wantsAnimation() const override { return false; }
 
 private:
   void reset();
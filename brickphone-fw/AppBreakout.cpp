@@ -10,7 +10,6 @@ AppBreakout::AppBreakout(AudioOutService& audio) : audioOut(audio) {}
 
 void AppBreakout::onEnter() {
   reset();
-  lastStepMs = millis();
 }
 
 void AppBreakout::handleInput(InputService& input) {
@@ -29,14 +28,11 @@ void AppBreakout::tick(unsigned long) {
   if (!launched) {
     ballX = paddleX + (kPaddleW / 2);
     ballY = 54;
-    return;
   }
+}
 
-  if (won) return;
-
-  unsigned long now = millis();
-  if (now - lastStepMs < stepIntervalMs) return;
-  lastStepMs = now;
+void AppBreakout::fixedUpdate() {
+  if (!launched || won) return;
 
   ballX += ballVX;
   ballY += ballVY;
@@ -92,7 +88,7 @@ void AppBreakout::tick(unsigned long) {
   }
 }
 
-void AppBreakout::render(DisplayService& display) {
+void AppBreakout::render(DisplayService& display, float) {
   for (int r = 0; r < kRows; ++r) {
     for (int c = 0; c < kCols; ++c) {
       if (bricks[r][c]) {
@@ -9,9 +9,12 @@ public:
   void onEnter() override;
   void handleInput(InputService& input) override;
   void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  unsigned long fixedStepMs() const override { return kStepMs; }
+  void fixedUpdate() override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
+  static const unsigned long kStepMs = 20;
   static const int kCols = 8;
   static const int kRows = 4;
   static const int kBrickW = 14;
@@ -27,8 +30,6 @@ private:
   int8_t ballVY = -1;
   int16_t paddleX = 50;
   bool launched = false;
-  unsigned long lastStepMs = 0;
-  unsigned long stepIntervalMs = 20;
   int8_t moveDir = 0;
   bool won = false;
 };
@@ -10,7 +10,6 @@ AppFlappy::AppFlappy(AudioOutService& audio) : audioOut(audio) {}
 
 void AppFlappy::onEnter() {
   reset();
-  lastStepMs = millis();
 }
 
 void AppFlappy::handleInput(InputService& input) {
@@ -21,11 +20,8 @@ void AppFlappy::handleInput(InputService& input) {
   }
 }
 
-void AppFlappy::tick(unsigned long) {
-  unsigned long now = millis();
-  if (now - lastStepMs < stepIntervalMs) return;
-  lastStepMs = now;
-
+void AppFlappy::fixedUpdate() {
+  prevBirdY = birdY;
   if (dead) return;
 
   birdV += 0.18f;
@@ -61,7 +57,7 @@ void AppFlappy::tick(unsigned long) {
   }
 }
 
-void AppFlappy::render(DisplayService& display) {
+void AppFlappy::render(DisplayService& display, float alpha) {
   for (int i = 0; i < 2; ++i) {
     int px = pipeX[i];
     int gapY = pipeGapY[i];
@@ -69,7 +65,7 @@ void AppFlappy::render(DisplayService& display) {
     display.fillRect(px, gapY + kGapH, kPipeW, 64 - (gapY + kGapH));
   }
 
-  display.fillRect(kBirdX, (int)birdY, 4, 4);
+  display.fillRect(kBirdX, (int)(prevBirdY + (birdY - prevBirdY) * alpha), 4, 4);
 
   char buf[8];
   snprintf(buf, sizeof(buf), "%d", score);
@@ -83,6 +79,7 @@ void AppFlappy::render(DisplayService& display) {
 
 void AppFlappy::reset() {
   birdY = 32.0f;
+  prevBirdY = birdY;
   birdV = 0.0f;
   pipeX[0] = 128;
   pipeX[1] = 128 + 60;
@@ -8,19 +8,21 @@ public:
   AppFlappy(AudioOutService& audio);
   void onEnter() override;
   void handleInput(InputService& input) override;
-  void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  unsigned long fixedStepMs() const override { return kStepMs; }
+  void fixedUpdate() override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
+  static const unsigned long kStepMs = 16;
+
   void reset();
 
   AudioOutService& audioOut;
   float birdY = 32.0f;
   float birdV = 0.0f;
+  float prevBirdY = 32.0f;   // before the last step, for interpolation
   int pipeX[2];
   int pipeGapY[2];
   int score = 0;
   bool dead = false;
-  unsigned long lastStepMs = 0;
-  unsigned long stepIntervalMs = 16;
 };
@@ -1,6 +1,7 @@
 #include "AppPong.h"
 #include "DisplayService.h"
 #include "InputService.h"
+#include <math.h>
 
 static const int kPaddleH = 16;
 static const int kPaddleW = 3;
@@ -16,7 +17,8 @@ void AppPong::onEnter() {
   paddleY = 24;
   aiY = 24;
   paused = false;
-  lastStepMs = millis();
+  prevBallX = ballX;
+  prevBallY = ballY;
 }
 
 void AppPong::handleInput(InputService& input) {
@@ -31,13 +33,11 @@ void AppPong::handleInput(InputService& input) {
   else if (input.down(BTN_DOWN)) moveDir = 1;
 }
 
-void AppPong::tick(unsigned long) {
+void AppPong::fixedUpdate() {
   if (paused) return;
 
-  unsigned long now = millis();
-  if (now - lastStepMs < stepIntervalMs) return;
-  lastStepMs = now;
-
+  prevBallX = ballX;
+  prevBallY = ballY;
   ballX += ballVX;
   ballY += ballVY;
 
@@ -59,8 +59,8 @@ void AppPong::tick(unsigned long) {
       audioOut.playSfx(SFX_CLICK);
     } else {
       aiScore++;
-      ballX = 64;
-      ballY = 32;
+      ballX = prevBallX = 64;
+      ballY = prevBallY = 32;
       ballVX = 1;
       ballVY = 1;
       audioOut.playSfx(SFX_OVER);
@@ -74,8 +74,8 @@ void AppPong::tick(unsigned long) {
       audioOut.playSfx(SFX_CLICK);
     } else {
       playerScore++;
-      ballX = 64;
-      ballY = 32;
+      ballX = prevBallX = 64;
+      ballY = prevBallY = 32;
       ballVX = -1;
       ballVY = 1;
       audioOut.playSfx(SFX_START);
@@ -89,10 +89,13 @@ void AppPong::tick(unsigned long) {
   if (aiY > 64 - kPaddleH) aiY = 64 - kPaddleH;
 }
 
-void AppPong::render(DisplayService& display) {
+void AppPong::render(DisplayService& display, float alpha) {
+  if (paused) alpha = 1.0f;
+  int16_t bx = prevBallX + (int16_t)lroundf((ballX - prevBallX) * alpha);
+  int16_t by = prevBallY + (int16_t)lroundf((ballY - prevBallY) * alpha);
   display.fillRect(0, paddleY, kPaddleW, kPaddleH);
   display.fillRect(128 - kPaddleW, aiY, kPaddleW, kPaddleH);
-  display.fillRect(ballX, ballY, kBallSize, kBallSize);
+  display.fillRect(bx, by, kBallSize, kBallSize);
 
   char score[12];
   snprintf(score, sizeof(score), "%d-%d", playerScore, aiScore);
@@ -8,14 +8,20 @@ public:
   AppPong(AudioOutService& audio);
   void onEnter() override;
   void handleInput(InputService& input) override;
-  void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  unsigned long fixedStepMs() const override { return kStepMs; }
+  void fixedUpdate() override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
+  static const unsigned long kStepMs = 16;
+
   AudioOutService& audioOut;
 
   int16_t ballX = 64;
   int16_t ballY = 32;
+  // Ball position before the last step, for render interpolation.
+  int16_t prevBallX = 64;
+  int16_t prevBallY = 32;
   int8_t ballVX = 1;
   int8_t ballVY = 1;
   int16_t paddleY = 24;
@@ -23,7 +29,5 @@ private:
   int playerScore = 0;
   int aiScore = 0;
   bool paused = false;
-  unsigned long lastStepMs = 0;
-  unsigned long stepIntervalMs = 16;
   int8_t moveDir = 0;
 };
@@ -2,22 +2,50 @@
 #include "DisplayService.h"
 #include "InputService.h"
 #include "Pins.h"
-#include <esp_heap_caps.h>
+#include <stdlib.h>
+#include <string.h>
 
-AppRecorder::AppRecorder(MicInService& mic, AudioOutService& audio)
-  : micIn(mic), audioOut(audio) {}
+static const char* kClipDir = "/rec";
+
+static void putLe16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void putLe32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Canonical 44-byte RIFF/WAVE header for PCM16 mono.
+static void buildWavHeader(uint8_t* h, uint32_t dataBytes) {
+  memcpy(h, "RIFF", 4);
+  putLe32(h + 4, 36 + dataBytes);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  putLe32(h + 16, 16);
+  putLe16(h + 20, 1);
+  putLe16(h + 22, 1);
+  putLe32(h + 24, AUDIO_SAMPLE_RATE);
+  putLe32(h + 28, AUDIO_SAMPLE_RATE * 2);
+  putLe16(h + 32, 2);
+  putLe16(h + 34, 16);
+  memcpy(h + 36, "data", 4);
+  putLe32(h + 40, dataBytes);
+}
+
+AppRecorder::AppRecorder(MicInService& mic, AudioOutService& audio, StorageService& store)
+  : micIn(mic), audioOut(audio), storage(store) {}
 
 void AppRecorder::onEnter() {
   micIn.setMode(MIC_OFF);
   playing = false;
-  ensureBuffer();
+  recording = false;
+  storage.makeDir(kClipDir);
+  scanClips();
 }
 
 void AppRecorder::onExit() {
-  micIn.setMode(MIC_OFF);
-  recording = false;
-  playing = false;
-  freeBuffer();
+  if (recording) stopRecording();
+  if (playing) stopPlayback();
 }
 
 void AppRecorder::handleInput(InputService& input) {
@@ -27,54 +55,88 @@ void AppRecorder::handleInput(InputService& input) {
     audioOut.playSfx(SFX_START);
   }
   if (input.pressed(BTN_B)) {
-    startPlayback();
-    audioOut.playSfx(SFX_START);
+    if (playing) {
+      stopPlayback();
+    } else {
+      startPlayback();
+      audioOut.playSfx(SFX_START);
+    }
   }
   if (input.pressed(BTN_SELECT)) {
-    clearRecording();
+    deleteSelected();
     audioOut.playSfx(SFX_CLICK);
   }
+  if (!recording && clipCount > 0) {
+    int prev = selected;
+    if (input.pressed(BTN_LEFT) && selected > 0) selected--;
+    if (input.pressed(BTN_RIGHT) && selected < clipCount - 1) selected++;
+    if (selected != prev) {
+      if (playing) stopPlayback();
+      audioOut.playSfx(SFX_CLICK);
+    }
+  }
 }
 
 void AppRecorder::tick(unsigned long) {
-  if (playing && buffer) {
-    int remaining = framesRecorded - playIndex;
-    if (remaining <= 0) {
-      playing = false;
-      return;
-    }
+  unsigned long now = millis();
+  if (playing) {
+    // Top up the PCM ring straight from flash.
     int freeFrames = audioOut.pcmFree();
-    if (freeFrames > 0) {
-      int toQueue = remaining > freeFrames ? freeFrames : remaining;
-      int queued = audioOut.playPcm(&buffer[playIndex], toQueue);
-      playIndex += queued;
+    while (freeFrames > 0) {
+      int chunk = freeFrames > AUDIO_FRAMES ? AUDIO_FRAMES : freeFrames;
+      int frames = (int)(storage.read(ioBuf, chunk * sizeof(int16_t)) / sizeof(int16_t));
+      if (frames <= 0) {
+        stopPlayback();
+        break;
+      }
+      audioOut.playPcm(ioBuf, frames);
+      freeFrames -= frames;
     }
   }
 
   if (!recording) return;
-  if (!buffer) {
-    recording = false;
-    return;
+  // usedBytes() walks the filesystem, so free space is polled once a second.
+  bool lowSpace = false;
+  if (now - lastSpaceCheckMs >= 1000) {
+    lastSpaceCheckMs = now;
+    lowSpace = storage.totalBytes() - storage.usedBytes() < kMinFreeBytes;
   }
-  int framesLeft = kMaxFrames - framesRecorded;
-  if (framesLeft <= 0) {
+  if (framesRecorded >= kMaxFrames || storage.writerFailed() || lowSpace) {
     stopRecording();
     return;
   }
 
-  int chunk = (framesLeft > AUDIO_FRAMES) ? AUDIO_FRAMES : framesLeft;
-  if (micIn.readPcm16(&buffer[framesRecorded], chunk)) {
+  // Catch up on everything the capture task queued since the last tick, as
+  // far as the writer's free block space allows; the rest waits in the
+  // mic ring.
+  for (;;) {
+    int chunk = (int)(storage.writeSpace() / sizeof(int16_t));
+    if (chunk > AUDIO_FRAMES) chunk = AUDIO_FRAMES;
+    if (chunk > kMaxFrames - framesRecorded) chunk = kMaxFrames - framesRecorded;
+    if (chunk <= 0 || !micIn.readPcm16(ioBuf, chunk)) break;
+    storage.write(ioBuf, chunk * sizeof(int16_t));
     framesRecorded += chunk;
   }
 }
 
-void AppRecorder::render(DisplayService& display) {
+void AppRecorder::render(DisplayService& display, float) {
   display.drawText(0, 0, "RECORDER", 1);
-  display.drawText(0, 16, recording ? "REC: ON" : "REC: OFF", 1);
 
-  char info[24];
-  int seconds = framesRecorded / AUDIO_SAMPLE_RATE;
-  snprintf(info, sizeof(info), "LEN: %ds", seconds);
+  char info[40];
+  if (recording) {
+    snprintf(info, sizeof(info), "REC: ON  #%03u", (unsigned)recordingId);
+  } else if (selected >= 0) {
+    snprintf(info, sizeof(info), "CLIP %d/%d  #%03u", selected + 1, clipCount,
+             (unsigned)clipIds[selected]);
+  } else {
+    snprintf(info, sizeof(info), "NO CLIPS");
+  }
+  display.drawText(0, 16, info, 1);
+
+  int frames = recording ? framesRecorded : (selected >= 0 ? clipFrames[selected] : 0);
+  int seconds = frames / AUDIO_SAMPLE_RATE;
+  snprintf(info, sizeof(info), "LEN: %d:%02d%s", seconds / 60, seconds % 60,
+           playing ? "  PLAY" : "");
   display.drawText(0, 28, info, 1);
 
   float level = micIn.rmsLevel();
@@ -83,15 +145,25 @@ void AppRecorder::render(DisplayService& display) {
   display.drawRect(0, 44, 100, 8);
   display.fillRect(0, 44, bar, 8);
 
-  display.drawText(0, 56, "A rec  B play  SEL clr", 1);
+  display.drawText(0, 56, "A rec  B play  SEL del", 1);
 }
 
 void AppRecorder::startRecording() {
-  if (!ensureBuffer()) return;
+  if (!storage.isMounted() || clipCount >= kMaxClips) return;
+  if (playing) stopPlayback();
+
+  recordingId = clipCount > 0 ? (uint16_t)(clipIds[clipCount - 1] + 1) : 1;
+  char path[24];
+  clipPath(recordingId, path, sizeof(path));
+  if (!storage.openWriter(path)) return;
+
+  // Placeholder; the real sizes are patched in when the clip is closed.
+  uint8_t header[kWavHeaderBytes];
+  buildWavHeader(header, 0);
+  storage.write(header, sizeof(header));
+
   framesRecorded = 0;
   recording = true;
-  playing = false;
-  playIndex = 0;
   audioOut.stop();
   micIn.setMode(MIC_LOCAL_RECORD);
 }
@@ -99,47 +171,72 @@ void AppRecorder::startRecording() {
 void AppRecorder::stopRecording() {
   recording = false;
   micIn.setMode(MIC_OFF);
+
+  uint8_t header[kWavHeaderBytes];
+  buildWavHeader(header, (uint32_t)framesRecorded * sizeof(int16_t));
+  storage.closeWriter(header, sizeof(header));
+  addClip(recordingId, framesRecorded);
 }
 
 void AppRecorder::startPlayback() {
-  if (!buffer || framesRecorded <= 0 || recording) return;
-  playing = true;
-  playIndex = 0;
+  if (recording || selected < 0 || clipFrames[selected] <= 0) return;
+  char path[24];
+  clipPath(clipIds[selected], path, sizeof(path));
+  if (!storage.openReader(path, kWavHeaderBytes)) return;
   audioOut.stop();
+  playing = true;
 }
 
-void AppRecorder::clearRecording() {
-  if (recording) return;
-  framesRecorded = 0;
+void AppRecorder::stopPlayback() {
   playing = false;
-  playIndex = 0;
-  audioOut.stop();
+  storage.closeReader();
 }
 
-bool AppRecorder::ensureBuffer() {
-  if (buffer) return true;
-  // Prefer PSRAM if available, else fallback to internal
-  buffer = (int16_t*)heap_caps_malloc(kMaxFrames * sizeof(int16_t),
-                                     MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-  if (!buffer) {
-    buffer = (int16_t*)heap_caps_malloc(kMaxFrames * sizeof(int16_t),
-                                       MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-  }
-  if (!buffer) {
-    recording = false;
-    playing = false;
-    framesRecorded = 0;
-    return false;
+void AppRecorder::deleteSelected() {
+  if (recording || selected < 0) return;
+  if (playing) {
+    stopPlayback();
+    audioOut.stop();
   }
-  framesRecorded = 0;
-  playing = false;
-  recording = false;
-  return true;
+  char path[24];
+  clipPath(clipIds[selected], path, sizeof(path));
+  storage.remove(path);
+  scanClips();
+}
+
+void AppRecorder::clipPath(uint16_t id, char* out, size_t len) const {
+  snprintf(out, len, "%s/%03u.wav", kClipDir, (unsigned)id);
 }
 
-void AppRecorder::freeBuffer() {
-  if (buffer) {
-    heap_caps_free(buffer);
-    buffer = nullptr;
+void AppRecorder::onClipFile(const char* name, size_t size, void* ctx) {
+  auto* self = static_cast<AppRecorder*>(ctx);
+  const char* base = strrchr(name, '/');
+  base = base ? base + 1 : name;
+  char* end = nullptr;
+  long id = strtol(base, &end, 10);
+  if (end == base || strcmp(end, ".wav") != 0 || id <= 0 || id > 0xFFFF) return;
+  int frames = size > kWavHeaderBytes ? (int)((size - kWavHeaderBytes) / sizeof(int16_t)) : 0;
+  self->addClip((uint16_t)id, frames);
+}
+
+// Keeps the clip list sorted by id and selects the clip just added.
+void AppRecorder::addClip(uint16_t id, int frames) {
+  if (clipCount >= kMaxClips) return;
+  int at = clipCount;
+  while (at > 0 && clipIds[at - 1] > id) {
+    clipIds[at] = clipIds[at - 1];
+    clipFrames[at] = clipFrames[at - 1];
+    at--;
   }
+  clipIds[at] = id;
+  clipFrames[at] = frames;
+  clipCount++;
+  selected = at;
+}
+
+void AppRecorder::scanClips() {
+  clipCount = 0;
+  selected = -1;
+  storage.listDir(kClipDir, onClipFile, this);
+  if (clipCount > 0) selected = clipCount - 1;
 }
@@ -3,34 +3,55 @@
 #include "Screen.h"
 #include "MicInService.h"
 #include "AudioOutService.h"
+#include "StorageService.h"
 #include "Pins.h"
 
 class AppRecorder : public Screen {
 public:
-  AppRecorder(MicInService& mic, AudioOutService& audio);
+  AppRecorder(MicInService& mic, AudioOutService& audio, StorageService& store);
   void onEnter() override;
   void onExit() override;
   void handleInput(InputService& input) override;
   void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  void render(DisplayService& display, float alpha) override;
+  bool wantsAnimation() const override { return recording || playing; }
 
 private:
   void startRecording();
   void stopRecording();
   void startPlayback();
-  void clearRecording();
+  void stopPlayback();
+  void deleteSelected();
+  void scanClips();
+  void addClip(uint16_t id, int frames);
+  void clipPath(uint16_t id, char* out, size_t len) const;
+  static void onClipFile(const char* name, size_t size, void* ctx);
 
   MicInService& micIn;
   AudioOutService& audioOut;
+  StorageService& storage;
 
-  static const int kMaxSeconds = 3;
+  // Clips are /rec/NNN.wav (PCM16 mono at AUDIO_SAMPLE_RATE), streamed to
+  // and from flash; only ioBuf lives in RAM. At 48 KB/s the ~8.9 MB
+  // LittleFS partition holds a little over 3 minutes in all, so that is
+  // also the cap on one take; kMinFreeBytes ends it sooner when other
+  // clips share the space.
+  static const int kMaxSeconds = 180;
   static const int kMaxFrames = AUDIO_SAMPLE_RATE * kMaxSeconds;
-  int16_t* buffer = nullptr;
+  static const int kMaxClips = 32;
+  static const size_t kWavHeaderBytes = 44;
+  // Stop recording while this much flash is still free.
+  static const size_t kMinFreeBytes = 64 * 1024;
+
+  uint16_t clipIds[kMaxClips];
+  int clipFrames[kMaxClips];
+  int clipCount = 0;
+  int selected = -1;
+
   int framesRecorded = 0;
+  uint16_t recordingId = 0;
   bool recording = false;
   bool playing = false;
-  int playIndex = 0;
-
-  bool ensureBuffer();
-  void freeBuffer();
+  unsigned long lastSpaceCheckMs = 0;
+  int16_t ioBuf[AUDIO_FRAMES];
 };
@@ -60,7 +60,7 @@ void AppSettings::handleInput(InputService& input) {
   }
 }
 
-void AppSettings::render(DisplayService& display) {
+void AppSettings::render(DisplayService& display, float) {
   display.drawText(0, 0, "SETTINGS", 1);
 
   char vol[16];
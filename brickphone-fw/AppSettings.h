@@ -16,7 +16,8 @@ public:
   AppSettings(AudioOutService& audio, NetService& net, ScreenManager& screens);
   void onEnter() override;
   void handleInput(InputService& input) override;
-  void render(DisplayService& display) override;
+  void render(DisplayService& display, float alpha) override;
+  bool wantsAnimation() const override { return false; }
 
 private:
   AudioOutService& audioOut;
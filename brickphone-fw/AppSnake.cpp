@@ -8,7 +8,6 @@ void AppSnake::onEnter() {
   resetGame();
   running = true;
   gameOver = false;
-  lastStepMs = millis();
 }
 
 void AppSnake::handleInput(InputService& input) {
@@ -28,20 +27,33 @@ void AppSnake::handleInput(InputService& input) {
     audioOut.playSfx(SFX_START);
   }
 
-  if (input.pressed(BTN_UP)) nextDir = DIR_UP;
-  else if (input.pressed(BTN_DOWN)) nextDir = DIR_DOWN;
-  else if (input.pressed(BTN_LEFT)) nextDir = DIR_LEFT;
-  else if (input.pressed(BTN_RIGHT)) nextDir = DIR_RIGHT;
+  for (uint8_t n = 0; n < input.eventCount(); ++n) {
+    const InputEvent& e = input.event(n);
+    if (!e.pressed) continue;
+    switch (e.id) {
+      case BTN_UP:    queueTurn(DIR_UP); break;
+      case BTN_DOWN:  queueTurn(DIR_DOWN); break;
+      case BTN_LEFT:  queueTurn(DIR_LEFT); break;
+      case BTN_RIGHT: queueTurn(DIR_RIGHT); break;
+      default: break;
+    }
+  }
 }
 
-void AppSnake::tick(unsigned long) {
-  if (!running || gameOver) return;
+void AppSnake::queueTurn(Dir d) {
+  Dir last = turnCount > 0 ? turns[turnCount - 1] : dir;
+  if (d == last || isOpposite(last, d) || turnCount == MAX_TURNS) return;
+  turns[turnCount++] = d;
+}
 
-  unsigned long now = millis();
-  if (now - lastStepMs < stepIntervalMs) return;
-  lastStepMs = now;
+void AppSnake::fixedUpdate() {
+  if (!running || gameOver) return;
 
-  if (!isOpposite(dir, nextDir)) dir = nextDir;
+  if (turnCount > 0) {
+    dir = turns[0];
+    for (int i = 1; i < turnCount; ++i) turns[i - 1] = turns[i];
+    turnCount--;
+  }
 
   Pt head = snake[0];
   switch (dir) {
@@ -68,7 +80,7 @@ void AppSnake::tick(unsigned long) {
   }
 }
 
-void AppSnake::render(DisplayService& display) {
+void AppSnake::render(DisplayService& display, float) {
   for (int i = 0; i < snakeLen; ++i) {
     int16_t x = snake[i].x * CELL;
     int16_t y = snake[i].y * CELL;
@@ -97,7 +109,7 @@ void AppSnake::resetGame() {
   snake[2] = { (uint8_t)(sx - 2), sy };
 
   dir = DIR_RIGHT;
-  nextDir = DIR_RIGHT;
+  turnCount = 0;
   spawnFood();
 }
 
@@ -8,8 +8,9 @@ public:
   AppSnake(AudioOutService& audio);
   void onEnter() override;
   void handleInput(InputService& input) override;
-  void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  unsigned long fixedStepMs() const override { return stepIntervalMs; }
+  void fixedUpdate() override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
   enum Dir { DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT };
@@ -19,22 +20,26 @@ private:
   void spawnFood();
   bool contains(uint8_t x, uint8_t y);
   bool isOpposite(Dir a, Dir b);
+  void queueTurn(Dir d);
 
   AudioOutService& audioOut;
   static const int CELL = 4;
   static const int GRID_W = 128 / CELL;
   static const int GRID_H = 64 / CELL;
   static const int MAX_CELLS = GRID_W * GRID_H;
+  // Turns pressed between steps apply one per step, so a quick UP-LEFT
+  // isn't collapsed into whichever came last.
+  static const int MAX_TURNS = 3;
 
   Pt snake[MAX_CELLS];
   int snakeLen = 0;
   Pt food;
   int score = 0;
   Dir dir = DIR_RIGHT;
-  Dir nextDir = DIR_RIGHT;
+  Dir turns[MAX_TURNS];
+  int turnCount = 0;
   bool running = false;
   bool gameOver = false;
-  unsigned long lastStepMs = 0;
   unsigned long stepIntervalMs = 120;
   bool fastMode = false;
   bool soundEnabled = true;
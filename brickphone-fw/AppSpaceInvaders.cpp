@@ -1,21 +1,14 @@
 #include "AppSpaceInvaders.h"
 #include "DisplayService.h"
 #include "InputService.h"
-
-static const uint8_t kInvaderA[] PROGMEM = {
-  0x3C, 0x7E, 0xDB, 0xFF, 0x24, 0x5A, 0xA5, 0x42
-};
-
-static const uint8_t kInvaderB[] PROGMEM = {
-  0x3C, 0x7E, 0xDB, 0xFF, 0x24, 0x18, 0x5A, 0xA5
-};
+#include "AssetIds.h"
 
 AppSpaceInvaders::AppSpaceInvaders(AudioOutService& audio) : audioOut(audio) {}
 
 void AppSpaceInvaders::onEnter() {
   reset();
-  lastStepMs = millis();
-  lastPlayerStepMs = lastStepMs;
+  swarmCountdown = kSwarmSteps;
+  playerCountdown = kPlayerSteps;
 }
 
 void AppSpaceInvaders::handleInput(InputService& input) {
@@ -33,12 +26,11 @@ void AppSpaceInvaders::handleInput(InputService& input) {
   if (input.pressed(BTN_B)) reset();
 }
 
-void AppSpaceInvaders::tick(unsigned long) {
+void AppSpaceInvaders::fixedUpdate() {
   if (won || lost) return;
 
-  unsigned long now = millis();
-  if (now - lastStepMs >= stepIntervalMs) {
-    lastStepMs = now;
+  if (--swarmCountdown <= 0) {
+    swarmCountdown = kSwarmSteps;
     swarmX += swarmDir * 2;
     int swarmWidth = kCols * kAlienW;
     if (swarmX <= 0 || swarmX + swarmWidth >= 128) {
@@ -49,8 +41,9 @@ void AppSpaceInvaders::tick(unsigned long) {
     animFrame = !animFrame;
   }
 
-  if (moveDir != 0 && now - lastPlayerStepMs >= playerStepIntervalMs) {
-    lastPlayerStepMs = now;
+  if (playerCountdown > 0) playerCountdown--;
+  if (moveDir != 0 && playerCountdown == 0) {
+    playerCountdown = kPlayerSteps;
     playerX += moveDir * 2;
     if (playerX < 0) playerX = 0;
     if (playerX > 128 - 10) playerX = 128 - 10;
@@ -88,14 +81,14 @@ void AppSpaceInvaders::tick(unsigned long) {
   }
 }
 
-void AppSpaceInvaders::render(DisplayService& display) {
-  const uint8_t* sprite = animFrame ? kInvaderA : kInvaderB;
+void AppSpaceInvaders::render(DisplayService& display, float) {
+  uint16_t sprite = animFrame ? ASSET_SPRITE_INVADER_A : ASSET_SPRITE_INVADER_B;
   for (int r = 0; r < kRows; ++r) {
     for (int c = 0; c < kCols; ++c) {
       if (!aliens[r][c]) continue;
       int ax = swarmX + c * kAlienW;
       int ay = swarmY + r * kAlienH;
-      display.drawBitmap(ax, ay, sprite, kAlienW, kAlienH);
+      display.drawAsset(ax, ay, sprite);
     }
   }
 
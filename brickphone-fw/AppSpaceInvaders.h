@@ -8,10 +8,16 @@ public:
   AppSpaceInvaders(AudioOutService& audio);
   void onEnter() override;
   void handleInput(InputService& input) override;
-  void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  unsigned long fixedStepMs() const override { return kStepMs; }
+  void fixedUpdate() override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
+  // The swarm moves every 220 ms, the player every 30 ms and the bullet
+  // every step.
+  static const unsigned long kStepMs = 10;
+  static const int kSwarmSteps = 22;
+  static const int kPlayerSteps = 3;
   static const int kCols = 8;
   static const int kRows = 4;
   static const int kAlienW = 8;
@@ -24,16 +30,14 @@ private:
   int16_t swarmX = 8;
   int16_t swarmY = 10;
   int8_t swarmDir = 1;
-  unsigned long lastStepMs = 0;
-  unsigned long stepIntervalMs = 220;
+  int swarmCountdown = kSwarmSteps;
 
   int16_t playerX = 56;
   bool bulletActive = false;
   int16_t bulletX = 0;
   int16_t bulletY = 0;
   int8_t moveDir = 0;
-  unsigned long lastPlayerStepMs = 0;
-  unsigned long playerStepIntervalMs = 30;
+  int playerCountdown = kPlayerSteps;
   bool animFrame = false;
   bool won = false;
   bool lost = false;
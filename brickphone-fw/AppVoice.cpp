@@ -4,8 +4,6 @@
 #include "secrets.h"
 #include "Pins.h"
 #include <WiFi.h>
-#include <driver/i2s.h>
-#include <math.h>
 #include <string.h>
 #include <esp_system.h>
 #include <esp_bt.h>
@@ -15,7 +13,21 @@ static const char* WS_PATH = "/voice";
 static const char* DEVICE_ID = "brick01";
 
 static const unsigned long PING_INTERVAL_MS = 12000;
-static const i2s_port_t I2S_OUT_PORT = I2S_NUM_1;
+// Frames the jitter buffer keeps queued in AudioOutService ahead of the DMA.
+static const int PLAYOUT_LOW_WATER_FRAMES = 2;
+// The socket is only read while the jitter buffer has this many free
+// slots; one ws.loop() delivers at most one downlink frame.
+static const int DOWNLINK_HEADROOM_FRAMES = 2;
+// Mic audio captured this soon after a beep or reply is ignored, so the
+// speaker does not open an utterance of its own.
+static const unsigned long PTT_HOLDOFF_MS = 100;
+static const unsigned long HANDS_FREE_HOLDOFF_MS = 300;
+// Speaker blocks within this window of a mic frame count as its echo
+// reference; covers the DMA timing estimate's slop plus room reverb.
+static const uint32_t ECHO_WINDOW_BEFORE_MS = 80;
+static const uint32_t ECHO_WINDOW_AFTER_MS = 40;
+// Consecutive double-talk frames before the reply is interrupted.
+static const int BARGE_IN_FRAMES = 4;
 
 static AppVoice* gAppVoice = nullptr;
 
@@ -32,14 +44,19 @@ void AppVoice::onEnter() {
   streaming = false;
   wsReady = false;
   startPending = false;
+  utteranceOpen = false;
+  preRollCount = 0;
   txSeq = 0;
   wsStarted = false;
   lastPingMs = millis();
   lastWifiAttemptMs = 0;
   wifiLoggedUp = false;
   errorMsg[0] = '\0';
-  audioOut.shutdown(); // free memory for TLS handshake
-  shutdownI2sOut();
+  audioOut.stop();
+  audioOut.setStreaming(true, FRAME_SAMPLES);
+  jitter.allocate(FRAME_SAMPLES);
+  uplinkResampler.begin(Resampler::DOWN_3_2);
+  downlinkResampler.begin(Resampler::UP_2_3);
   micIn.setMode(MIC_OFF);
   startWifi();
 }
@@ -47,8 +64,9 @@ void AppVoice::onEnter() {
 void AppVoice::onExit() {
   streaming = false;
   micIn.setMode(MIC_OFF);
-  shutdownI2sOut();
-  audioOut.begin(); // restore audio for other screens
+  audioOut.stop();
+  audioOut.setStreaming(false);
+  jitter.release();
   ws.disconnect();
   wsReady = false;
   wsStarted = false;
@@ -81,7 +99,9 @@ void AppVoice::startWebSocket() {
 void AppVoice::sendHello() {
   String msg = String("{\"type\":\"hello\",\"device_id\":\"") + DEVICE_ID +
                String("\",\"auth\":\"") + BRICKPHONE_TOKEN +
-               String("\",\"sample_rate\":24000,\"channels\":1}");
+               String("\",\"sample_rate\":24000,\"channels\":1") +
+               String(",\"sample_rates\":[16000,24000]") +
+               String(",\"codecs\":[\"ima_adpcm\",\"pcm16\"]}");
   ws.sendTXT(msg);
 }
 
@@ -93,40 +113,169 @@ void AppVoice::sendStop() {
   ws.sendTXT("{\"type\":\"stop\"}");
 }
 
+void AppVoice::sendInterrupt() {
+  ws.sendTXT("{\"type\":\"interrupt\"}");
+}
+
 void AppVoice::sendPing() {
   String msg = String("{\"type\":\"ping\",\"t\":") + String(millis()) + "}";
   ws.sendTXT(msg);
 }
 
-void AppVoice::sendAudioFrame(bool startFlag, bool endFlag) {
+// `pcm` may be null for the silent END frame. Version 1 frames carry raw
+// PCM16; version 2 adds a 4-byte codec preamble (codec id, step index,
+// predictor) ahead of the IMA-ADPCM payload.
+void AppVoice::sendAudioFrame(const int16_t* pcm, bool startFlag, bool endFlag, uint32_t ts) {
+  static const int16_t silence[FRAME_SAMPLES] = {};
+  if (!pcm) pcm = silence;
+  bool adpcm = uplinkCodec == CODEC_IMA_ADPCM;
+
+  int samples = FRAME_SAMPLES;
+  if (narrowband) {
+    if (startFlag) uplinkResampler.reset();
+    samples = uplinkResampler.process(pcm, FRAME_SAMPLES, resamplePcm);
+    pcm = resamplePcm;
+  }
+
   // Header: magic, version, flags, seq, samples, timestamp
   txFrame[0] = 0xB1;
   txFrame[1] = 0xA0;
-  txFrame[2] = 0x01;
+  txFrame[2] = adpcm ? 0x02 : 0x01;
   uint8_t flags = 0;
   if (startFlag) flags |= 0x01;
   if (endFlag) flags |= 0x02;
   txFrame[3] = flags;
   txFrame[4] = (uint8_t)(txSeq & 0xFF);
   txFrame[5] = (uint8_t)((txSeq >> 8) & 0xFF);
-  txFrame[6] = (uint8_t)(FRAME_SAMPLES & 0xFF);
-  txFrame[7] = (uint8_t)((FRAME_SAMPLES >> 8) & 0xFF);
-  uint32_t ts = millis();
+  txFrame[6] = (uint8_t)(samples & 0xFF);
+  txFrame[7] = (uint8_t)((samples >> 8) & 0xFF);
   txFrame[8] = (uint8_t)(ts & 0xFF);
   txFrame[9] = (uint8_t)((ts >> 8) & 0xFF);
   txFrame[10] = (uint8_t)((ts >> 16) & 0xFF);
   txFrame[11] = (uint8_t)((ts >> 24) & 0xFF);
   txSeq = (uint16_t)(txSeq + 1);
 
-  memcpy(txFrame + 12, micPcm, FRAME_BYTES);
-  ws.sendBIN(txFrame, sizeof(txFrame));
+  if (!adpcm) {
+    memcpy(txFrame + 12, pcm, samples * sizeof(int16_t));
+    ws.sendBIN(txFrame, 12 + samples * sizeof(int16_t));
+    return;
+  }
+
+  if (startFlag) adpcmEncoder.reset();
+  int16_t pred = adpcmEncoder.predictor();
+  txFrame[12] = CODEC_IMA_ADPCM;
+  txFrame[13] = adpcmEncoder.stepIndex();
+  txFrame[14] = (uint8_t)(pred & 0xFF);
+  txFrame[15] = (uint8_t)((pred >> 8) & 0xFF);
+  int bytes = adpcmEncoder.encode(pcm, samples, txFrame + 16);
+  ws.sendBIN(txFrame, 16 + bytes);
+}
+
+// Gates the uplink on the MicInService VAD. Voiced frames are sent, with
+// the pre-roll replayed ahead of them; unvoiced frames only refill the
+// pre-roll. In hands-free mode the end of speech also ends the utterance.
+void AppVoice::processCapturedFrames() {
+  MicFrameInfo info;
+  while (micIn.readPcm16(micPcm, FRAME_SAMPLES, &info)) {
+    uint32_t ts = (uint32_t)(info.captureUs / 1000);
+    if ((int32_t)(ts - listenHoldoffUntilMs) < 0) {
+      preRollCount = 0;
+      continue;
+    }
+
+    // While the reply plays, only frames that clearly beat the echo estimate
+    // can be speech; a run of them barges in on the reply.
+    if (!utteranceOpen) {
+      float ref = audioOut.referenceLevel(ts - ECHO_WINDOW_BEFORE_MS, ts + ECHO_WINDOW_AFTER_MS);
+      if (EchoSuppressor::farEndActive(ref)) {
+        bool nearEnd = echo.update(info.meanSq, ref) && info.voiced;
+        bargeInFrames = nearEnd ? bargeInFrames + 1 : 0;
+        if (bargeInFrames >= BARGE_IN_FRAMES) {
+          bargeIn();
+        } else {
+          info.voiced = false;
+        }
+      } else {
+        bargeInFrames = 0;
+      }
+    }
+
+    if (info.voiced) {
+      if (!utteranceOpen) {
+        utteranceOpen = true;
+        startPending = true;
+        uiState = UI_STREAMING;
+        sendStart();
+      }
+      flushPreRoll();
+      bool startFlag = startPending;
+      startPending = false;
+      sendAudioFrame(micPcm, startFlag, false, ts);
+    } else if (handsFree && utteranceOpen) {
+      endUtterance();
+      listenHoldoffUntilMs = millis() + HANDS_FREE_HOLDOFF_MS;
+      audioOut.playToneMidi(76, 80);
+    } else {
+      memcpy(preRollPcm[preRollHead], micPcm, sizeof(micPcm));
+      preRollTs[preRollHead] = ts;
+      preRollHead = (preRollHead + 1) % PRE_ROLL_FRAMES;
+      if (preRollCount < PRE_ROLL_FRAMES) preRollCount++;
+    }
+  }
+}
+
+void AppVoice::flushPreRoll() {
+  int idx = (preRollHead - preRollCount + PRE_ROLL_FRAMES) % PRE_ROLL_FRAMES;
+  for (int i = 0; i < preRollCount; ++i) {
+    bool startFlag = startPending;
+    startPending = false;
+    sendAudioFrame(preRollPcm[idx], startFlag, false, preRollTs[idx]);
+    idx = (idx + 1) % PRE_ROLL_FRAMES;
+  }
+  preRollCount = 0;
+}
+
+// Cuts the reply short: the worker cancels the response, and any of its
+// frames still in flight are dropped until the next stream starts.
+void AppVoice::bargeIn() {
+  bargeInFrames = 0;
+  sendInterrupt();
+  audioOut.stop();
+  jitter.reset();
+  dropDownlinkUntilStart = true;
+}
+
+void AppVoice::endUtterance() {
+  utteranceOpen = false;
+  startPending = false;
+  preRollCount = 0;
+  sendAudioFrame(nullptr, false, true, millis());
+  sendStop();
+  uiState = UI_READY;
+}
+
+void AppVoice::setHandsFree(bool on) {
+  if (utteranceOpen) endUtterance();
+  handsFree = on;
+  preRollCount = 0;
+  micIn.setMode(on ? MIC_BACKEND_STREAM : MIC_OFF);
+  uiState = UI_READY;
 }
 
 void AppVoice::handleJson(const String& text) {
   if (text.indexOf("\"type\":\"ready\"") >= 0) {
     wsReady = true;
     uiState = UI_READY;
-    initI2sOut();
+    // Servers that predate codec negotiation omit the field: stay on PCM16.
+    uplinkCodec = text.indexOf("\"codec\":\"ima_adpcm\"") >= 0 ? CODEC_IMA_ADPCM : CODEC_PCM16;
+    // Same for sample_rates: anything but an explicit 16000 runs at 24 kHz.
+    narrowband = text.indexOf("\"sample_rate\":16000") >= 0;
+    uplinkResampler.reset();
+    downlinkResampler.reset();
+    echo.reset();
+    bargeInFrames = 0;
+    dropDownlinkUntilStart = false;
+    if (handsFree) micIn.setMode(MIC_BACKEND_STREAM);
   }
   if (text.indexOf("\"type\":\"error\"") >= 0) {
     setError(text.c_str());
@@ -137,25 +286,43 @@ void AppVoice::handleBinary(const uint8_t* data, size_t len) {
   if (len < 12) return;
   uint16_t magic = data[0] | (data[1] << 8);
   uint8_t version = data[2];
+  uint8_t flags = data[3];
+  uint16_t seq = data[4] | (data[5] << 8);
   uint16_t samples = data[6] | (data[7] << 8);
+  uint32_t ts = (uint32_t)data[8] | ((uint32_t)data[9] << 8) |
+                ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);
   size_t expected = 12 + samples * 2;
   if (magic != 0xA0B1 || version != 1 || expected != len) return;
+  // 16 kHz frames are upsampled into resamplePcm, which holds 20 ms at 24 kHz.
+  if (narrowband && samples > FRAME_SAMPLES * 2 / 3) return;
   const int16_t* pcm = reinterpret_cast<const int16_t*>(data + 12);
 
-  if (!i2sOutStarted) return;
-  int remaining = samples;
-  int offset = 0;
-  while (remaining > 0) {
-    int chunk = remaining > FRAME_SAMPLES ? FRAME_SAMPLES : remaining;
-    for (int i = 0; i < chunk; ++i) {
-      int16_t s = pcm[offset + i];
-      outStereo[2 * i] = s;
-      outStereo[2 * i + 1] = s;
+  if (dropDownlinkUntilStart) {
+    if (!(flags & 0x01)) return;
+    dropDownlinkUntilStart = false;
+  }
+  jitter.push(seq, ts, flags, pcm, samples, millis());
+  pumpPlayout();
+}
+
+// AudioOutService's DMA is the playout clock: keep a couple of frames
+// queued there and let the jitter buffer decide what they contain.
+void AppVoice::pumpPlayout() {
+  while (audioOut.pcmQueued() < FRAME_SAMPLES * PLAYOUT_LOW_WATER_FRAMES) {
+    int samples = 0;
+    bool starving = audioOut.pcmQueued() < FRAME_SAMPLES / 4;
+    JitterBuffer::PopResult r = jitter.pop(playoutPcm, &samples, starving);
+    if (r == JitterBuffer::POP_NONE) break;
+    if (narrowband) {
+      samples = downlinkResampler.process(playoutPcm, samples, resamplePcm);
+      audioOut.playPcm(resamplePcm, samples);
+    } else {
+      audioOut.playPcm(playoutPcm, samples);
+    }
+    if (r == JitterBuffer::POP_END) {
+      audioOut.drainPcm();
+      break;
     }
-    size_t bytesWritten = 0;
-    i2s_write(I2S_OUT_PORT, outStereo, chunk * 2 * sizeof(int16_t), &bytesWritten, portMAX_DELAY);
-    remaining -= chunk;
-    offset += chunk;
   }
 }
 
@@ -170,6 +337,8 @@ void AppVoice::onWsEvent(WStype_t type, uint8_t* payload, size_t length) {
       wsReady = false;
       streaming = false;
       startPending = false;
+      utteranceOpen = false;
+      micIn.setMode(MIC_OFF);
       wsStarted = false;
       uiState = (WiFi.status() == WL_CONNECTED) ? UI_WS_CONNECTING : UI_WIFI_CONNECTING;
       break;
@@ -201,23 +370,29 @@ void AppVoice::wsEventThunk(WStype_t type, uint8_t* payload, size_t length) {
 void AppVoice::handleInput(InputService& input) {
   if (!wsReady) return;
 
+  if (input.pressed(BTN_SELECT) && !streaming) {
+    setHandsFree(!handsFree);
+    return;
+  }
+  if (handsFree) return;
+
   if (input.pressed(BTN_A) && !streaming) {
+    if (audioOut.isPcmPlaying()) bargeIn();
     streaming = true;
-    startPending = true;
+    preRollCount = 0;
     uiState = UI_STREAMING;
-    sendStart();
+    listenHoldoffUntilMs = millis() + PTT_HOLDOFF_MS;
     micIn.setMode(MIC_BACKEND_STREAM);
-    playBeep(880, 60);
+    audioOut.playToneMidi(81, 60);
   }
 
   if (input.released(BTN_A) && streaming) {
+    processCapturedFrames();
     streaming = false;
     micIn.setMode(MIC_OFF);
-    memset(micPcm, 0, sizeof(micPcm));
-    sendAudioFrame(false, true);
-    sendStop();
+    if (utteranceOpen) endUtterance();
     uiState = wsReady ? UI_READY : UI_WS_CONNECTING;
-    playBeep(660, 80);
+    audioOut.playToneMidi(76, 80);
   }
 }
 
@@ -227,9 +402,10 @@ void AppVoice::tick(unsigned long) {
   if (WiFi.status() != WL_CONNECTED) {
     wsStarted = false;
     wsReady = false;
-    if (streaming) {
+    if (streaming || handsFree) {
       streaming = false;
       startPending = false;
+      utteranceOpen = false;
       micIn.setMode(MIC_OFF);
     }
     if (now - lastWifiAttemptMs > 4000) {
@@ -242,25 +418,23 @@ void AppVoice::tick(unsigned long) {
   }
 
   if (!wsStarted) startWebSocket();
-  ws.loop();
+  // Replies arrive faster than real time. Rather than drop what doesn't
+  // fit, leave it in the socket: TCP flow control then holds the worker
+  // back until playout frees a slot (one per 20 ms frame).
+  pumpPlayout();
+  if (jitter.space() >= DOWNLINK_HEADROOM_FRAMES) ws.loop();
 
   if (!wsReady) return;
 
-  if (streaming) {
-    if (micIn.readPcm16(micPcm, FRAME_SAMPLES)) {
-      bool startFlag = startPending;
-      startPending = false;
-      sendAudioFrame(startFlag, false);
-    }
-  } else {
-    if (now - lastPingMs > PING_INTERVAL_MS) {
-      lastPingMs = now;
-      sendPing();
-    }
+  if (streaming || handsFree) processCapturedFrames();
+
+  if (!utteranceOpen && now - lastPingMs > PING_INTERVAL_MS) {
+    lastPingMs = now;
+    sendPing();
   }
 }
 
-void AppVoice::render(DisplayService& display) {
+void AppVoice::render(DisplayService& display, float) {
   display.drawText(0, 0, "VOICE", 1);
   IPAddress ip = WiFi.localIP();
   char net[24];
@@ -282,11 +456,11 @@ void AppVoice::render(DisplayService& display) {
       break;
     case UI_READY:
       display.drawCentered("READY", 24, 2);
-      display.drawText(0, 56, "Hold A to talk", 1);
+      display.drawText(0, 56, handsFree ? "Just talk  SEL: PTT" : "Hold A  SEL: auto", 1);
       break;
     case UI_STREAMING:
       display.drawCentered("LISTENING", 24, 2);
-      display.drawText(0, 56, "Release A to send", 1);
+      display.drawText(0, 56, handsFree ? "Pause to send" : "Release A to send", 1);
       break;
     case UI_ERROR:
       display.drawCentered("ERROR", 16, 2);
@@ -294,63 +468,3 @@ void AppVoice::render(DisplayService& display) {
       break;
   }
 }
-
-void AppVoice::initI2sOut() {
-  if (i2sOutStarted) return;
-
-  i2s_config_t cfg = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-    .sample_rate = AUDIO_SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-    .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = 0,
-    .dma_buf_count = 8,
-    .dma_buf_len = FRAME_SAMPLES,
-    .use_apll = false,
-    .tx_desc_auto_clear = true,
-    .fixed_mclk = 0
-  };
-
-  i2s_pin_config_t pins = {
-    .bck_io_num = PIN_I2S_OUT_BCK,
-    .ws_io_num = PIN_I2S_OUT_WS,
-    .data_out_num = PIN_I2S_OUT_DO,
-    .data_in_num = I2S_PIN_NO_CHANGE
-  };
-
-  i2s_driver_install(I2S_OUT_PORT, &cfg, 0, NULL);
-  i2s_set_pin(I2S_OUT_PORT, &pins);
-  i2s_set_clk(I2S_OUT_PORT, AUDIO_SAMPLE_RATE, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_STEREO);
-  i2sOutStarted = true;
-}
-
-void AppVoice::shutdownI2sOut() {
-  if (!i2sOutStarted) return;
-  i2s_driver_uninstall(I2S_OUT_PORT);
-  i2sOutStarted = false;
-}
-
-void AppVoice::playBeep(int freq, int ms) {
-  if (!i2sOutStarted) return;
-
-  int totalSamples = (ms * AUDIO_SAMPLE_RATE) / 1000;
-  int offset = 0;
-  float phase = 0.0f;
-  float step = 2.0f * (float)M_PI * (float)freq / (float)AUDIO_SAMPLE_RATE;
-
-  while (offset < totalSamples) {
-    int chunk = FRAME_SAMPLES;
-    if (totalSamples - offset < chunk) chunk = totalSamples - offset;
-    for (int i = 0; i < chunk; ++i) {
-      int16_t s = (int16_t)(sinf(phase) * 3000.0f);
-      phase += step;
-      if (phase > 2.0f * (float)M_PI) phase -= 2.0f * (float)M_PI;
-      beepBuf[2 * i] = s;
-      beepBuf[2 * i + 1] = s;
-    }
-    size_t bytesWritten = 0;
-    i2s_write(I2S_OUT_PORT, beepBuf, chunk * 2 * sizeof(int16_t), &bytesWritten, portMAX_DELAY);
-    offset += chunk;
-  }
-}
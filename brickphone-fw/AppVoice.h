@@ -4,6 +4,10 @@
 #include <WebSocketsClient.h>
 #include "MicInService.h"
 #include "AudioOutService.h"
+#include "JitterBuffer.h"
+#include "ImaAdpcm.h"
+#include "Resampler.h"
+#include "EchoSuppressor.h"
 
 class AppVoice : public Screen {
 public:
@@ -12,7 +16,7 @@ public:
   void onExit() override;
   void handleInput(InputService& input) override;
   void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
   enum UiState {
@@ -23,20 +27,30 @@ private:
     UI_ERROR
   };
 
+  // Uplink codec ids, as sent in the version 2 frame preamble.
+  enum UplinkCodec : uint8_t {
+    CODEC_PCM16 = 0,
+    CODEC_IMA_ADPCM = 1
+  };
+
   void startWifi();
   void startWebSocket();
   void sendHello();
   void sendStart();
   void sendStop();
   void sendPing();
-  void sendAudioFrame(bool startFlag, bool endFlag);
+  void sendInterrupt();
+  void sendAudioFrame(const int16_t* pcm, bool startFlag, bool endFlag, uint32_t ts);
+  void processCapturedFrames();
+  void flushPreRoll();
+  void endUtterance();
+  void bargeIn();
+  void setHandsFree(bool on);
   void handleJson(const String& text);
   void handleBinary(const uint8_t* data, size_t len);
+  void pumpPlayout();
   void onWsEvent(WStype_t type, uint8_t* payload, size_t length);
   void setError(const char* msg);
-  void initI2sOut();
-  void shutdownI2sOut();
-  void playBeep(int freq, int ms);
 
   static void wsEventThunk(WStype_t type, uint8_t* payload, size_t length);
 
@@ -48,6 +62,14 @@ private:
   bool wsReady = false;
   bool streaming = false;
   bool startPending = false;
+  // An utterance opens on the first voiced frame, not on the key press,
+  // so a press with no speech sends nothing at all.
+  bool utteranceOpen = false;
+  bool handsFree = false;
+  unsigned long listenHoldoffUntilMs = 0;
+  EchoSuppressor echo;
+  int bargeInFrames = 0;
+  bool dropDownlinkUntilStart = false;
   uint16_t txSeq = 0;
   unsigned long lastPingMs = 0;
   unsigned long lastWifiAttemptMs = 0;
@@ -57,10 +79,23 @@ private:
   static const int FRAME_SAMPLES = 480;
   static const int FRAME_BYTES = FRAME_SAMPLES * 2;
   int16_t micPcm[FRAME_SAMPLES];
+  // Recent unvoiced frames, replayed ahead of speech so the VAD onset
+  // delay does not clip the first syllable.
+  static const int PRE_ROLL_FRAMES = 8;
+  int16_t preRollPcm[PRE_ROLL_FRAMES][FRAME_SAMPLES];
+  uint32_t preRollTs[PRE_ROLL_FRAMES];
+  int preRollHead = 0;
+  int preRollCount = 0;
   uint8_t txFrame[12 + FRAME_BYTES];
-  int16_t outStereo[FRAME_SAMPLES * 2];
-  int16_t beepBuf[FRAME_SAMPLES * 2];
-  bool i2sOutStarted = false;
+  UplinkCodec uplinkCodec = CODEC_PCM16;
+  ImaAdpcmEncoder adpcmEncoder;
+  // 16 kHz session: frames on the wire are 320 samples; I2S stays 24 kHz.
+  bool narrowband = false;
+  Resampler uplinkResampler;
+  Resampler downlinkResampler;
+  int16_t resamplePcm[FRAME_SAMPLES + 1];
+  JitterBuffer jitter;
+  int16_t playoutPcm[FRAME_SAMPLES];
 
   char errorMsg[64] = "";
 };
@@ -0,0 +1,25 @@
+#pragma once
+
+// Generated by tools/pack_assets.py from assets/manifest.json; do not edit.
+
+#include <stdint.h>
+
+enum AssetId : uint16_t {
+  ASSET_ICON_ARROW       = 1,
+  ASSET_ICON_VOICE       = 2,
+  ASSET_ICON_REC         = 3,
+  ASSET_ICON_SNAKE       = 4,
+  ASSET_ICON_PONG        = 5,
+  ASSET_ICON_BREAKOUT    = 6,
+  ASSET_ICON_INVADERS    = 7,
+  ASSET_ICON_2048        = 8,
+  ASSET_ICON_FLAPPY      = 9,
+  ASSET_ICON_SETTINGS    = 10,
+  ASSET_SPRITE_INVADER_A = 32,
+  ASSET_SPRITE_INVADER_B = 33,
+  ASSET_SFX_BOOT         = 64,
+  ASSET_SFX_CLICK        = 65,
+  ASSET_SFX_START        = 66,
+  ASSET_SFX_EAT          = 67,
+  ASSET_SFX_OVER         = 68,
+};
@@ -0,0 +1,127 @@
+#include "AssetPack.h"
+#include "Icons.h"
+#include <esp_rom_crc.h>
+#include <string.h>
+
+// Built-in copies of the stock assets, used when no pack is flashed.
+// Notes are int32 {midi, ms} pairs, the same layout the pack stores.
+static const int32_t kSfxBoot[]  = { 76, 120, 74, 120, 77, 120, 79, 120, 73, 160, 71, 160, 76, 200 };
+static const int32_t kSfxClick[] = { 79, 40 };
+static const int32_t kSfxStart[] = { 72, 50, 79, 50, 84, 60 };
+static const int32_t kSfxEat[]   = { 84, 50, 88, 60 };
+static const int32_t kSfxOver[]  = { 60, 120, 55, 180 };
+
+struct BuiltinAsset {
+  uint16_t id;
+  AssetType type;
+  const void* data;
+  uint32_t size;
+  uint16_t w;
+  uint16_t h;
+};
+
+#define BUILTIN_BITMAP(id, bits, w, h) { id, ASSET_BITMAP, bits, sizeof(bits), w, h }
+#define BUILTIN_NOTES(id, notes) \
+  { id, ASSET_NOTES, notes, sizeof(notes), (uint16_t)(sizeof(notes) / (2 * sizeof(int32_t))), 0 }
+
+static const BuiltinAsset kBuiltins[] = {
+  BUILTIN_BITMAP(ASSET_ICON_ARROW, ICON_ARROW_8X8, 8, 8),
+  BUILTIN_BITMAP(ASSET_ICON_VOICE, ICON_VOICE_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_REC, ICON_REC_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_SNAKE, ICON_SNAKE_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_PONG, ICON_PONG_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_BREAKOUT, ICON_BREAKOUT_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_INVADERS, ICON_INVADERS_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_2048, ICON_2048_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_FLAPPY, ICON_FLAPPY_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_ICON_SETTINGS, ICON_SETTINGS_16X16, 16, 16),
+  BUILTIN_BITMAP(ASSET_SPRITE_INVADER_A, SPRITE_INVADER_A_8X8, 8, 8),
+  BUILTIN_BITMAP(ASSET_SPRITE_INVADER_B, SPRITE_INVADER_B_8X8, 8, 8),
+  BUILTIN_NOTES(ASSET_SFX_BOOT, kSfxBoot),
+  BUILTIN_NOTES(ASSET_SFX_CLICK, kSfxClick),
+  BUILTIN_NOTES(ASSET_SFX_START, kSfxStart),
+  BUILTIN_NOTES(ASSET_SFX_EAT, kSfxEat),
+  BUILTIN_NOTES(ASSET_SFX_OVER, kSfxOver),
+};
+
+bool AssetPack::begin() {
+  if (entries) return true;
+  const esp_partition_t* part =
+    esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "assets");
+  if (!part) return false;
+
+  // Read the header first so only the pack itself, not the whole
+  // partition, takes up MMU pages.
+  Header header;
+  if (esp_partition_read(part, 0, &header, sizeof(header)) != ESP_OK) return false;
+  if (memcmp(header.magic, "BPAK", 4) != 0 || header.version != kVersion) return false;
+  if (header.totalBytes < sizeof(Header) || header.totalBytes > part->size) return false;
+
+  const void* mapped = nullptr;
+  if (esp_partition_mmap(part, 0, header.totalBytes, ESP_PARTITION_MMAP_DATA,
+                         &mapped, &mapHandle) != ESP_OK) {
+    return false;
+  }
+  if (!validate(static_cast<const uint8_t*>(mapped), header.totalBytes)) {
+    esp_partition_munmap(mapHandle);
+    mapHandle = 0;
+    return false;
+  }
+  return true;
+}
+
+// Rejects a half-written or stale pack before anything points into it.
+bool AssetPack::validate(const uint8_t* pack, uint32_t mappedBytes) {
+  const Header* header = reinterpret_cast<const Header*>(pack);
+  uint32_t tableEnd = sizeof(Header) + (uint32_t)header->count * sizeof(Entry);
+  if (tableEnd > mappedBytes) return false;
+  uint32_t crc = esp_rom_crc32_le(0, pack + sizeof(Header), mappedBytes - sizeof(Header));
+  if (crc != header->crc32) return false;
+
+  const Entry* table = reinterpret_cast<const Entry*>(pack + sizeof(Header));
+  for (uint16_t i = 0; i < header->count; ++i) {
+    const Entry& e = table[i];
+    if (e.offset < tableEnd || e.offset > mappedBytes || e.size > mappedBytes - e.offset) {
+      return false;
+    }
+    // Blobs are 4-byte aligned so notes and PCM can be read in place.
+    if (e.offset & 3) return false;
+    if (i > 0 && table[i - 1].id >= e.id) return false;
+  }
+
+  base = pack;
+  entries = table;
+  entryCount = header->count;
+  return true;
+}
+
+bool AssetPack::find(uint16_t id, Asset* out) const {
+  // The packer sorts the table by id.
+  int lo = 0;
+  int hi = (int)entryCount - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    const Entry& e = entries[mid];
+    if (e.id == id) {
+      out->data = base + e.offset;
+      out->size = e.size;
+      out->w = e.w;
+      out->h = e.h;
+      out->type = (AssetType)e.type;
+      return true;
+    }
+    if (e.id < id) lo = mid + 1;
+    else hi = mid - 1;
+  }
+
+  for (const BuiltinAsset& b : kBuiltins) {
+    if (b.id != id) continue;
+    out->data = static_cast<const uint8_t*>(b.data);
+    out->size = b.size;
+    out->w = b.w;
+    out->h = b.h;
+    out->type = b.type;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "AssetIds.h"
+
+enum AssetType : uint8_t {
+  ASSET_BITMAP = 1,   // 1bpp, row-major, MSB first; w x h pixels
+  ASSET_NOTES = 2,    // int32 {midi, ms} pairs; w = note count
+  ASSET_PCM16 = 3     // mono PCM16 at AUDIO_SAMPLE_RATE; w = sample rate
+};
+
+// Read-only sprites, fonts and sound banks. begin() maps the "assets" flash
+// partition (built by tools/pack_assets.py) into the data address space, and
+// lookups return pointers straight into it; nothing is copied to RAM. IDs
+// the pack lacks, or every ID on a board flashed without a pack, resolve to
+// the copies built into the firmware (Icons.h, AssetPack.cpp).
+class AssetPack {
+public:
+  struct Asset {
+    const uint8_t* data;
+    uint32_t size;
+    uint16_t w;
+    uint16_t h;
+    AssetType type;
+  };
+
+  // Returns false (built-ins only) when the partition is missing or holds
+  // no valid pack.
+  bool begin();
+  bool isMapped() const { return entries != nullptr; }
+  uint16_t mappedCount() const { return entryCount; }
+  bool find(uint16_t id, Asset* out) const;
+
+private:
+  static const uint16_t kVersion = 1;
+
+  struct __attribute__((packed)) Header {
+    char magic[4];
+    uint16_t version;
+    uint16_t count;
+    uint32_t totalBytes;
+    uint32_t crc32;
+  };
+
+  struct __attribute__((packed)) Entry {
+    uint16_t id;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t w;
+    uint16_t h;
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  bool validate(const uint8_t* pack, uint32_t mappedBytes);
+
+  const uint8_t* base = nullptr;
+  const Entry* entries = nullptr;
+  uint16_t entryCount = 0;
+  esp_partition_mmap_handle_t mapHandle = 0;
+};
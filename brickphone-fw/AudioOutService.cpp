@@ -1,27 +1,100 @@
 #include "AudioOutService.h"
 #include "Pins.h"
+#include "AssetPack.h"
+#include "StorageService.h"
 #include "driver/i2s.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <math.h>
 
 #define I2S_OUT_PORT I2S_NUM_1
 #define MAX_AMP      16000
 
+int16_t AudioOutService::sineTable[1 << AudioOutService::kSineBits];
+uint32_t AudioOutService::midiPhaseInc[128];
+bool AudioOutService::tablesReady = false;
+
 static inline float midiToHz(int midi) {
   return 440.0f * powf(2.0f, (midi - 69) / 12.0f);
 }
 
+static inline uint16_t gainToQ15(float gain) {
+  if (gain < 0.0f) gain = 0.0f;
+  if (gain > 1.0f) gain = 1.0f;
+  return (uint16_t)(gain * 32767.0f);
+}
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > 32767) return 32767;
+  if (v < -32768) return -32768;
+  return (int16_t)v;
+}
+
+// One-time float work: a Q15 sine table and the 32-bit phase increment for
+// every MIDI note, so the audio task never calls sinf()/powf().
+void AudioOutService::buildTables() {
+  if (tablesReady) return;
+  const int size = 1 << kSineBits;
+  for (int i = 0; i < size; ++i) {
+    sineTable[i] = (int16_t)lrintf(sinf(2.0f * (float)M_PI * i / size) * 32767.0f);
+  }
+  for (int m = 0; m < 128; ++m) {
+    double inc = (double)midiToHz(m) / AUDIO_SAMPLE_RATE * 4294967296.0;
+    midiPhaseInc[m] = (uint32_t)inc;
+  }
+  tablesReady = true;
+}
+
 void AudioOutService::begin() {
   if (taskRunning) return;
+  buildTables();
+  if (!pcmStorage) {
+    pcmStorage = (int16_t*)heap_caps_malloc(PCM_RING_FRAMES * sizeof(int16_t),
+                                           MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (pcmStorage) {
+      pcmRing.init(pcmStorage, PCM_RING_FRAMES);
+    } else {
+      pcmStorage = (int16_t*)heap_caps_malloc(PCM_RING_FRAMES_INTERNAL * sizeof(int16_t),
+                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+      if (pcmStorage) pcmRing.init(pcmStorage, PCM_RING_FRAMES_INTERNAL);
+    }
+  }
+  if (commands.capacity() == 0) commands.init(commandStorage, kCommandSlots);
+
+  installI2sOut(AUDIO_FRAMES);
 
+  taskRunning = true;
+  xTaskCreatePinnedToCore(audioTaskThunk, "audioOut", 4096, this, 2, &taskHandle, 1);
+}
+
+void AudioOutService::shutdown() {
+  if (!taskRunning) return;
+  taskRunning = false;
+  wakeTask();
+  taskHandle = nullptr;
+  uninstallI2sOut();
+  pcmRing.clear();
+  commands.clear();
+}
+
+void AudioOutService::installI2sOut(int dmaFrames) {
+  // A full queue has to play through a flash stall (the recorder beeps
+  // while it writes).
+  static_assert(kDmaBufCount * AUDIO_FRAMES * 1000 / AUDIO_SAMPLE_RATE >= StorageService::kFlashStallMs,
+                "speaker DMA queue shorter than a flash stall");
   i2s_config_t cfg = {
     .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
     .sample_rate = AUDIO_SAMPLE_RATE,
     .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+#if AUDIO_OUT_MONO
+    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+#else
     .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
+#endif
     .communication_format = I2S_COMM_FORMAT_STAND_I2S,
     .intr_alloc_flags = 0,
-    .dma_buf_count = 8,
-    .dma_buf_len = AUDIO_FRAMES,
+    .dma_buf_count = kDmaBufCount,
+    .dma_buf_len = dmaFrames,
     .use_apll = false,
     .tx_desc_auto_clear = true,
     .fixed_mclk = 0
@@ -36,29 +109,56 @@ void AudioOutService::begin() {
 
   i2s_driver_install(I2S_OUT_PORT, &cfg, 0, NULL);
   i2s_set_pin(I2S_OUT_PORT, &pins);
+#if AUDIO_OUT_MONO
+  i2s_set_clk(I2S_OUT_PORT, AUDIO_SAMPLE_RATE, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_MONO);
+#else
   i2s_set_clk(I2S_OUT_PORT, AUDIO_SAMPLE_RATE, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_STEREO);
-
-  taskRunning = true;
-  xTaskCreatePinnedToCore(audioTaskThunk, "audioOut", 4096, this, 2, &taskHandle, 1);
+#endif
 }
 
-void AudioOutService::shutdown() {
-  if (!taskRunning) return;
-  taskRunning = false;
-  taskHandle = nullptr;
+void AudioOutService::uninstallI2sOut() {
   i2s_driver_uninstall(I2S_OUT_PORT);
-  portENTER_CRITICAL(&pcmMux);
-  pcmHead = 0;
-  pcmTail = 0;
-  pcmCount = 0;
-  portEXIT_CRITICAL(&pcmMux);
-  sequence = nullptr;
-  sequenceLen = 0;
-  sequenceIndex = 0;
-  currentMidi = -1;
-  noteSamplesLeft = 0;
-  noteTotalSamples = 0;
-  playing = false;
+}
+
+size_t AudioOutService::writeI2sOut(const int16_t* mono, int frames, TickType_t wait) {
+  size_t written = 0;
+#if AUDIO_OUT_MONO
+  i2s_write(I2S_OUT_PORT, mono, frames * sizeof(int16_t), &written, wait);
+  return written / sizeof(int16_t);
+#else
+  alignas(4) static int16_t stereo[AUDIO_FRAMES * 2];
+  int done = 0;
+  while (done < frames) {
+    int chunk = frames - done;
+    if (chunk > AUDIO_FRAMES) chunk = AUDIO_FRAMES;
+    duplicateToStereo(mono + done, stereo, chunk);
+    size_t bytes = 0;
+    i2s_write(I2S_OUT_PORT, stereo, chunk * 2 * sizeof(int16_t), &bytes, wait);
+    written += bytes;
+    if (bytes < chunk * 2 * sizeof(int16_t)) break;
+    done += chunk;
+  }
+  return written / (2 * sizeof(int16_t));
+#endif
+}
+
+typedef uint32_t __attribute__((may_alias)) StereoPair;
+
+// Writes each L/R pair as one 32-bit store, two samples per iteration.
+// `stereo` must be 4-byte aligned.
+void AudioOutService::duplicateToStereo(const int16_t* mono, int16_t* stereo, int frames) {
+  StereoPair* out = reinterpret_cast<StereoPair*>(stereo);
+  int i = 0;
+  for (; i + 1 < frames; i += 2) {
+    uint32_t a = (uint16_t)mono[i];
+    uint32_t b = (uint16_t)mono[i + 1];
+    out[i] = a | (a << 16);
+    out[i + 1] = b | (b << 16);
+  }
+  if (i < frames) {
+    uint32_t a = (uint16_t)mono[i];
+    out[i] = a | (a << 16);
+  }
 }
 
 void AudioOutService::tick(unsigned long) {
@@ -71,142 +171,308 @@ void AudioOutService::setVolume(float vol) {
   volume = vol;
 }
 
+void AudioOutService::setPcmGain(float gain) {
+  pcmGainQ15 = gainToQ15(gain);
+}
+
 int AudioOutService::pcmFree() const {
-  int freeFrames = 0;
-  portENTER_CRITICAL(&const_cast<AudioOutService*>(this)->pcmMux);
-  freeFrames = PCM_RING_FRAMES - pcmCount;
-  portEXIT_CRITICAL(&const_cast<AudioOutService*>(this)->pcmMux);
-  return freeFrames;
+  return (int)pcmRing.space();
 }
 
-void AudioOutService::playToneMidi(int midi, int ms) {
-  Note single = { midi, ms };
-  startSequence(&single, 1);
+void AudioOutService::playToneMidi(int midi, int ms, float gain, Waveform wave) {
+  Command cmd = {};
+  cmd.type = CMD_START;
+  cmd.len = 1;
+  cmd.gainQ15 = gainToQ15(gain);
+  cmd.wave = wave;
+  cmd.single = { midi, ms };
+  pushCommand(cmd);
 }
 
-void AudioOutService::playSfx(SfxId id) {
-  static const Note boot[]  = {
-    {76, 120}, {74, 120}, {77, 120}, {79, 120},
-    {73, 160}, {71, 160}, {76, 200}
+void AudioOutService::playSfx(SfxId id, float gain) {
+  static const uint16_t kSfxAssets[] = {
+    ASSET_SFX_BOOT, ASSET_SFX_CLICK, ASSET_SFX_START, ASSET_SFX_EAT, ASSET_SFX_OVER
   };
-  static const Note click[] = { {79, 40} };
-  static const Note start[] = { {72, 50}, {79, 50}, {84, 60} };
-  static const Note eat[]   = { {84, 50}, {88, 60} };
-  static const Note over[]  = { {60, 120}, {55, 180} };
+  static_assert(sizeof(Note) == 2 * sizeof(int32_t), "Note must match the pack's note layout");
 
-  switch (id) {
-    case SFX_BOOT:  startSequence(boot, sizeof(boot) / sizeof(boot[0])); break;
-    case SFX_CLICK: startSequence(click, sizeof(click) / sizeof(click[0])); break;
-    case SFX_START: startSequence(start, sizeof(start) / sizeof(start[0])); break;
-    case SFX_EAT:   startSequence(eat, sizeof(eat) / sizeof(eat[0])); break;
-    case SFX_OVER:  startSequence(over, sizeof(over) / sizeof(over[0])); break;
+  if ((unsigned)id >= sizeof(kSfxAssets) / sizeof(kSfxAssets[0])) return;
+  AssetPack::Asset a;
+  if (!assets || !assets->find(kSfxAssets[id], &a)) return;
+  // The audio task reads both kinds in place; pack blobs are 4-byte aligned.
+  if (a.type == ASSET_NOTES) {
+    uint32_t len = a.size / sizeof(Note);
+    if (len > 255) len = 255;
+    startSequence(reinterpret_cast<const Note*>(a.data), (uint8_t)len, gain);
+  } else if (a.type == ASSET_PCM16) {
+    startSample(reinterpret_cast<const int16_t*>(a.data), (int)(a.size / sizeof(int16_t)), gain);
   }
 }
 
 int AudioOutService::playPcm(const int16_t* pcm, int frames) {
-  if (!pcm || frames <= 0) return 0;
-  int queued = 0;
-  portENTER_CRITICAL(&pcmMux);
-  for (int i = 0; i < frames; ++i) {
-    if (pcmCount >= PCM_RING_FRAMES) break;
-    pcmRing[pcmHead] = pcm[i];
-    pcmHead = (pcmHead + 1) % PCM_RING_FRAMES;
-    pcmCount++;
-    queued++;
-  }
-  portEXIT_CRITICAL(&pcmMux);
+  if (!pcm || frames <= 0 || pcmRing.capacity() == 0) return 0;
+  int queued = (int)pcmRing.push(pcm, (uint32_t)frames);
+  if (queued < frames) overruns += frames - queued;
+  if (queued > 0) wakeTask();
   return queued;
 }
 
 void AudioOutService::stop() {
-  playing = false;
-  sequence = nullptr;
-  sequenceLen = 0;
-  sequenceIndex = 0;
-  currentMidi = -1;
-  noteSamplesLeft = 0;
-  noteTotalSamples = 0;
-  portENTER_CRITICAL(&pcmMux);
-  pcmHead = 0;
-  pcmTail = 0;
-  pcmCount = 0;
-  portEXIT_CRITICAL(&pcmMux);
-}
-
-void AudioOutService::startSequence(const Note* seq, uint8_t len) {
-  sequence = seq;
-  sequenceLen = len;
-  sequenceIndex = 0;
-  playing = true;
-  advanceNote();
-}
-
-bool AudioOutService::advanceNote() {
-  if (!sequence || sequenceIndex >= sequenceLen) {
-    stop();
+  Command cmd = {};
+  cmd.type = CMD_STOP_ALL;
+  pushCommand(cmd);
+  pcmRing.clear();
+}
+
+void AudioOutService::setStreaming(bool on, int prebufferFrames) {
+  if (prebufferFrames < 0) prebufferFrames = 0;
+  if (pcmRing.capacity() && prebufferFrames > (int)pcmRing.capacity()) {
+    prebufferFrames = (int)pcmRing.capacity();
+  }
+  prebuffer = prebufferFrames;
+  streaming = on;
+}
+
+void AudioOutService::startSequence(const Note* seq, uint8_t len, float gain) {
+  Command cmd = {};
+  cmd.type = CMD_START;
+  cmd.len = len;
+  cmd.gainQ15 = gainToQ15(gain);
+  cmd.wave = WAVE_SINE;
+  cmd.sequence = seq;
+  pushCommand(cmd);
+}
+
+void AudioOutService::startSample(const int16_t* pcm, int frames, float gain) {
+  if (!pcm || frames <= 0) return;
+  Command cmd = {};
+  cmd.type = CMD_START;
+  cmd.gainQ15 = gainToQ15(gain);
+  cmd.sample = pcm;
+  cmd.sampleLen = frames;
+  pushCommand(cmd);
+}
+
+void AudioOutService::pushCommand(const Command& cmd) {
+  if (commands.capacity() == 0) return;
+  if (commands.push(&cmd, 1)) wakeTask();
+}
+
+// Notifications count, so one given before the task parks isn't lost.
+void AudioOutService::wakeTask() {
+  if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+void AudioOutService::applyCommands() {
+  Command cmd;
+  while (commands.pop(&cmd, 1)) {
+    if (cmd.type == CMD_STOP_ALL) {
+      for (int i = 0; i < kSynthVoices; ++i) voices[i].active = false;
+    } else {
+      startVoice(cmd);
+    }
+  }
+}
+
+// Takes a free voice, or steals the oldest one when all are busy.
+void AudioOutService::startVoice(const Command& cmd) {
+  Voice* v = &voices[0];
+  for (int i = 0; i < kSynthVoices; ++i) {
+    if (!voices[i].active) {
+      v = &voices[i];
+      break;
+    }
+    if (voices[i].startOrder < v->startOrder) v = &voices[i];
+  }
+
+  v->single = cmd.single;
+  v->sequence = cmd.sequence ? cmd.sequence : &v->single;
+  v->sequenceLen = cmd.len;
+  v->sequenceIndex = 0;
+  v->sample = cmd.sample;
+  v->sampleLen = cmd.sampleLen;
+  v->samplePos = 0;
+  v->gainQ15 = cmd.gainQ15;
+  v->wave = cmd.wave;
+  v->startOrder = voiceOrder++;
+  v->phase = 0;
+  v->active = true;
+  if (!v->sample) advanceNote(*v);
+}
+
+bool AudioOutService::advanceNote(Voice& v) {
+  if (!v.sequence || v.sequenceIndex >= v.sequenceLen) {
+    v.active = false;
     return false;
   }
-  currentMidi = sequence[sequenceIndex].midi;
-  int ms = sequence[sequenceIndex].ms;
-  noteTotalSamples = (int)((ms / 1000.0f) * AUDIO_SAMPLE_RATE);
-  if (noteTotalSamples < 1) noteTotalSamples = 1;
-  noteSamplesLeft = noteTotalSamples;
-  sequenceIndex++;
+  int midi = v.sequence[v.sequenceIndex].midi;
+  if (midi < 0) midi = 0;
+  if (midi > 127) midi = 127;
+  int ms = v.sequence[v.sequenceIndex].ms;
+  v.phaseInc = midiPhaseInc[midi];
+  v.noteTotalSamples = (ms * AUDIO_SAMPLE_RATE) / 1000;
+  if (v.noteTotalSamples < 1) v.noteTotalSamples = 1;
+  v.noteSamplesLeft = v.noteTotalSamples;
+
+  // Linear attack over the first 1/12 and release over the last 1/8,
+  // as Q24 per-sample steps; Q16 truncation left a ~4% step at each end.
+  v.attackSamples = v.noteTotalSamples / 12;
+  v.releaseSamples = v.noteTotalSamples / 8;
+  if (v.attackSamples < 1) v.attackSamples = 1;
+  if (v.releaseSamples < 1) v.releaseSamples = 1;
+  v.attackStep = kEnvOne / v.attackSamples;
+  v.releaseStep = kEnvOne / v.releaseSamples;
+  v.sequenceIndex++;
   return true;
 }
 
-void AudioOutService::renderFrames(int frames) {
-  static int16_t buffer[AUDIO_FRAMES * 2];
+bool AudioOutService::anyVoiceActive() const {
+  for (int i = 0; i < kSynthVoices; ++i) {
+    if (voices[i].active) return true;
+  }
+  return false;
+}
 
-  for (int i = 0; i < frames; ++i) {
-    int16_t sample = 0;
-    if (currentMidi >= 0 && noteSamplesLeft > 0) {
-      float freq = midiToHz(currentMidi);
-      int sampleIndex = noteTotalSamples - noteSamplesLeft;
-      float env = 1.0f;
-      int attack = noteTotalSamples / 12;
-      int release = noteTotalSamples / 8;
-      if (attack < 1) attack = 1;
-      if (release < 1) release = 1;
-      if (sampleIndex < attack) env = (float)sampleIndex / (float)attack;
-      else if (noteSamplesLeft < release) env = (float)noteSamplesLeft / (float)release;
-
-      phase += 2.0f * (float)M_PI * freq / (float)AUDIO_SAMPLE_RATE;
-      if (phase > 2.0f * (float)M_PI) phase -= 2.0f * (float)M_PI;
-
-      float s = sinf(phase) * env * volume;
-      sample = (int16_t)(s * MAX_AMP);
-      noteSamplesLeft--;
+template <Waveform W>
+void AudioOutService::renderSegment(int32_t* acc, int n, uint32_t& phase, uint32_t inc,
+                                    int32_t amp, int32_t env, int32_t envStep) {
+  uint32_t ph = phase;
+  for (int i = 0; i < n; ++i) {
+    int32_t w;
+    if (W == WAVE_SINE) {
+      w = sineTable[ph >> (32 - kSineBits)];
+    } else if (W == WAVE_SQUARE) {
+      w = (ph & 0x80000000u) ? -32767 : 32767;
+    } else {
+      // Fold the top 17 bits of phase into a -32768..32767 triangle.
+      int32_t t = (int32_t)(ph >> 15) - 65536;
+      w = (t < 0 ? -t : t) - 32768;
+    }
+    acc[i] += (((w * amp) >> 15) * (env >> 8)) >> 16;
+    env += envStep;
+    ph += inc;
+  }
+  phase = ph;
+}
+
+// Renders the voice in runs of constant envelope slope (attack, sustain,
+// release) so the inner loop is a table read and two multiplies.
+void AudioOutService::mixSynth(Voice& v, int32_t* acc, int frames) {
+  if (v.sample) {
+    mixSample(v, acc, frames);
+    return;
+  }
+  int32_t amp = (int32_t)(volume * MAX_AMP * v.gainQ15 / 32767.0f);
+
+  int i = 0;
+  while (i < frames && v.active) {
+    if (v.noteSamplesLeft <= 0) {
+      advanceNote(v);
+      continue;
     }
 
-    buffer[2 * i] = sample;
-    buffer[2 * i + 1] = sample;
+    int index = v.noteTotalSamples - v.noteSamplesLeft;
+    int32_t env;
+    int32_t step;
+    int run;
+    if (index < v.attackSamples) {
+      env = index * v.attackStep;
+      step = v.attackStep;
+      run = v.attackSamples - index;
+    } else if (v.noteSamplesLeft > v.releaseSamples) {
+      env = kEnvOne;
+      step = 0;
+      run = v.noteSamplesLeft - v.releaseSamples;
+    } else {
+      env = v.noteSamplesLeft * v.releaseStep;
+      step = -v.releaseStep;
+      run = v.noteSamplesLeft;
+    }
+    if (run > frames - i) run = frames - i;
 
-    if (noteSamplesLeft <= 0 && playing) {
-      advanceNote();
+    switch (v.wave) {
+      case WAVE_SINE:     renderSegment<WAVE_SINE>(acc + i, run, v.phase, v.phaseInc, amp, env, step); break;
+      case WAVE_SQUARE:   renderSegment<WAVE_SQUARE>(acc + i, run, v.phase, v.phaseInc, amp, env, step); break;
+      case WAVE_TRIANGLE: renderSegment<WAVE_TRIANGLE>(acc + i, run, v.phase, v.phaseInc, amp, env, step); break;
     }
+    v.noteSamplesLeft -= run;
+    i += run;
   }
+}
+
+// Full-scale samples peak where a full-gain synth note does.
+void AudioOutService::mixSample(Voice& v, int32_t* acc, int frames) {
+  int32_t amp = (int32_t)(volume * MAX_AMP * v.gainQ15 / 32767.0f);
+  int n = v.sampleLen - v.samplePos;
+  if (n > frames) n = frames;
+  const int16_t* src = v.sample + v.samplePos;
+  for (int i = 0; i < n; ++i) {
+    acc[i] += (src[i] * amp) >> 15;
+  }
+  v.samplePos += n;
+  if (v.samplePos >= v.sampleLen) v.active = false;
+}
 
-  size_t bytesWritten = 0;
-  i2s_write(I2S_OUT_PORT, buffer, frames * 2 * sizeof(int16_t), &bytesWritten, portMAX_DELAY);
+// Returns the number of PCM frames mixed in.
+int AudioOutService::mixPcm(int32_t* acc, int frames) {
+  static int16_t mono[AUDIO_FRAMES];
+  if (drainRequested) {
+    drainRequested = false;
+    pcmPrimed = true;
+  }
+  if (streaming && !pcmPrimed) {
+    if ((int)pcmRing.size() < prebuffer) return 0;
+    pcmPrimed = true;
+  }
+  int got = (int)pcmRing.pop(mono, (uint32_t)frames);
+  if (got < frames) pcmPrimed = false;
+  if (got > 0 && got < frames) underruns++;
+  int32_t gain = pcmGainQ15;
+  for (int i = 0; i < got; ++i) {
+    acc[i] += (mono[i] * gain) >> 15;
+  }
+  return got;
 }
 
-void AudioOutService::renderPcmFrames(int frames) {
-  static int16_t buffer[AUDIO_FRAMES * 2];
+void AudioOutService::renderFrames(int frames) {
+  static int32_t acc[AUDIO_FRAMES];
+  static int16_t buffer[AUDIO_FRAMES];
+
+  memset(acc, 0, frames * sizeof(int32_t));
+  for (int v = 0; v < kSynthVoices; ++v) {
+    if (voices[v].active) mixSynth(voices[v], acc, frames);
+  }
+  mixPcm(acc, frames);
+
   for (int i = 0; i < frames; ++i) {
-    int16_t s = 0;
-    portENTER_CRITICAL(&pcmMux);
-    if (pcmCount > 0) {
-      s = pcmRing[pcmTail];
-      pcmTail = (pcmTail + 1) % PCM_RING_FRAMES;
-      pcmCount--;
+    buffer[i] = saturate16(acc[i]);
+  }
+  writeI2sOut(buffer, frames, portMAX_DELAY);
+  recordReference(buffer, frames);
+}
+
+void AudioOutService::recordReference(const int16_t* pcm, int frames) {
+  int64_t sumSq = 0;
+  for (int i = 0; i < frames; ++i) sumSq += (int32_t)pcm[i] * pcm[i];
+
+  // The blocking write just returned, so this block sits at the back of a
+  // full DMA queue.
+  uint32_t queueMs = (uint32_t)kDmaBufCount * AUDIO_FRAMES * 1000 / AUDIO_SAMPLE_RATE;
+  RefBlock& slot = refHistory[refWrite % kRefBlocks];
+  slot.meanSq = (float)sumSq / (float)frames;
+  slot.playMs = (uint32_t)(esp_timer_get_time() / 1000) + queueMs;
+  refWrite++;
+}
+
+float AudioOutService::referenceLevel(uint32_t fromMs, uint32_t toMs) const {
+  float level = 0.0f;
+  for (int i = 0; i < kRefBlocks; ++i) {
+    uint32_t at = refHistory[i].playMs;
+    if ((int32_t)(at - fromMs) >= 0 && (int32_t)(toMs - at) >= 0) {
+      float m = refHistory[i].meanSq;
+      if (m > level) level = m;
     }
-    portEXIT_CRITICAL(&pcmMux);
-    buffer[2 * i] = s;
-    buffer[2 * i + 1] = s;
   }
-  size_t bytesWritten = 0;
-  i2s_write(I2S_OUT_PORT, buffer, frames * 2 * sizeof(int16_t), &bytesWritten, portMAX_DELAY);
+  return level;
 }
 
 void AudioOutService::audioTaskThunk(void* arg) {
@@ -215,13 +481,18 @@ void AudioOutService::audioTaskThunk(void* arg) {
 }
 
 void AudioOutService::audioTaskLoop() {
+  for (int i = 0; i < kSynthVoices; ++i) voices[i].active = false;
+
   while (taskRunning) {
-    if (pcmCount > 0) {
-      renderPcmFrames(AUDIO_FRAMES);
-    } else if (playing) {
+    applyCommands();
+    if (anyVoiceActive() || pcmRing.size() > 0) {
       renderFrames(AUDIO_FRAMES);
     } else {
-      vTaskDelay(1);
+      // Nothing to play: block until pushCommand() or playPcm() has work,
+      // instead of waking every tick to look.
+      parked = true;
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      parked = false;
     }
   }
   vTaskDelete(nullptr);
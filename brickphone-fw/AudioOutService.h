@@ -1,6 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
+#include "SpscRing.h"
+
+class AssetPack;
 
 enum SfxId {
   SFX_BOOT = 0,
@@ -10,50 +13,169 @@ enum SfxId {
   SFX_OVER
 };
 
+enum Waveform : uint8_t {
+  WAVE_SINE = 0,
+  WAVE_SQUARE,
+  WAVE_TRIANGLE
+};
+
 class AudioOutService {
 public:
   void begin();
   void shutdown();
   void tick(unsigned long nowMs);
   void setVolume(float vol);
-  void playToneMidi(int midi, int ms);
-  void playSfx(SfxId id);
+  void setPcmGain(float gain);
+  // SFX come from the asset pack: note sequences for the synth, or PCM16
+  // samples mixed straight out of mapped flash.
+  void setAssets(const AssetPack* pack) { assets = pack; }
+  void playToneMidi(int midi, int ms, float gain = 1.0f, Waveform wave = WAVE_SINE);
+  void playSfx(SfxId id, float gain = 1.0f);
   int playPcm(const int16_t* pcm, int frames);
   int pcmFree() const;
+  int pcmQueued() const { return (int)pcmRing.size(); }
   void stop();
-  bool isPcmPlaying() const { return pcmCount > 0; }
+  // Streaming mode treats the PCM ring as a jitter buffer: playout waits
+  // until `prebufferFrames` are queued, and re-primes after running dry.
+  void setStreaming(bool on, int prebufferFrames = 0);
+  // Starts playout of whatever is queued without waiting for the prebuffer
+  // (end of a stream).
+  void drainPcm() { drainRequested = true; }
+  bool isPcmPlaying() const { return pcmRing.size() > 0; }
+  // Nothing playing or queued: the audio task is parked on its
+  // notification. The DMA queue may still be draining its last ~170 ms.
+  bool isIdle() const { return parked && commands.size() == 0 && pcmRing.size() == 0; }
+  // Audio blocks that ran out of queued PCM part-way through.
+  uint32_t pcmUnderruns() const { return underruns; }
+  // PCM frames rejected by playPcm() because the ring was full.
+  uint32_t pcmOverruns() const { return overruns; }
+  // Echo reference for the mic path: the loudest mean square among blocks
+  // whose estimated speaker time (esp_timer ms) falls in [fromMs, toMs].
+  float referenceLevel(uint32_t fromMs, uint32_t toMs) const;
+
+  // Mono -> interleaved L/R for stereo I2S builds; `stereo` must be
+  // 4-byte aligned.
+  static void duplicateToStereo(const int16_t* mono, int16_t* stereo, int frames);
 
 private:
+  // host-sim/src/osc_bench.cpp times mixSynth() against the float
+  // oscillator it replaced.
+  friend class OscBench;
+
   struct Note {
     int midi;
     int ms;
   };
 
-  void startSequence(const Note* seq, uint8_t len);
-  bool advanceNote();
+  // One synth voice playing a note sequence, or a PCM sample when `sample`
+  // is set. Owned by the audio task.
+  struct Voice {
+    const Note* sequence;
+    const int16_t* sample;
+    int sampleLen;
+    int samplePos;
+    uint8_t sequenceLen;
+    uint8_t sequenceIndex;
+    Note single;
+    uint16_t gainQ15;
+    Waveform wave;
+    uint32_t startOrder;
+    uint32_t phase;
+    uint32_t phaseInc;
+    int32_t attackStep;
+    int32_t releaseStep;
+    int attackSamples;
+    int releaseSamples;
+    int noteSamplesLeft;
+    int noteTotalSamples;
+    bool active;
+  };
+
+  enum CommandType : uint8_t {
+    CMD_START = 0,
+    CMD_STOP_ALL
+  };
+
+  // Main-loop requests handed to the audio task, which owns all voice state.
+  struct Command {
+    CommandType type;
+    uint8_t len;
+    uint16_t gainQ15;
+    Waveform wave;
+    const Note* sequence;
+    Note single;
+    const int16_t* sample;
+    int sampleLen;
+  };
+
+  static const int kSynthVoices = 4;
+  static const int kSineBits = 10;
+  static const int32_t kEnvOne = 1 << 24;  // envelope unity, Q24
+  static const int kCommandSlots = 16;
+
+  // Speaker I2S driver. Writes take mono PCM; in stereo builds it is
+  // duplicated into both slots on the fly.
+  static void installI2sOut(int dmaFrames);
+  static void uninstallI2sOut();
+  static size_t writeI2sOut(const int16_t* mono, int frames, TickType_t wait);
+  static void buildTables();
+  template <Waveform W>
+  static void renderSegment(int32_t* acc, int n, uint32_t& phase, uint32_t inc,
+                            int32_t amp, int32_t env, int32_t envStep);
+  void startSequence(const Note* seq, uint8_t len, float gain);
+  void startSample(const int16_t* pcm, int frames, float gain);
+  void pushCommand(const Command& cmd);
+  void wakeTask();
+  void applyCommands();
+  void startVoice(const Command& cmd);
+  bool advanceNote(Voice& v);
+  bool anyVoiceActive() const;
+  void mixSynth(Voice& v, int32_t* acc, int frames);
+  void mixSample(Voice& v, int32_t* acc, int frames);
+  int mixPcm(int32_t* acc, int frames);
   void renderFrames(int frames);
-  void renderPcmFrames(int frames);
   static void audioTaskThunk(void* arg);
   void audioTaskLoop();
 
+  static int16_t sineTable[1 << kSineBits];
+  static uint32_t midiPhaseInc[128];
+  static bool tablesReady;
+
   float volume = 0.2f;
-  float phase = 0.0f;
-  int noteSamplesLeft = 0;
-  int noteTotalSamples = 0;
-  int currentMidi = -1;
-
-  const Note* sequence = nullptr;
-  uint8_t sequenceLen = 0;
-  uint8_t sequenceIndex = 0;
-  bool playing = false;
-
-  static const int PCM_RING_FRAMES = 2048;
-  int16_t pcmRing[PCM_RING_FRAMES];
-  volatile int pcmHead = 0;
-  volatile int pcmTail = 0;
-  volatile int pcmCount = 0;
-  portMUX_TYPE pcmMux = portMUX_INITIALIZER_UNLOCKED;
+  volatile uint16_t pcmGainQ15 = 32767;
+  const AssetPack* assets = nullptr;
+
+  Voice voices[kSynthVoices] = {};
+  uint32_t voiceOrder = 0;
+  Command commandStorage[kCommandSlots];
+  SpscRing<Command> commands;
+
+  // ~680 ms at 24 kHz when PSRAM is available, else 85 ms of internal RAM.
+  static const int PCM_RING_FRAMES = 16384;
+  static const int PCM_RING_FRAMES_INTERNAL = 2048;
+  int16_t* pcmStorage = nullptr;
+  SpscRing<int16_t> pcmRing;
+  volatile bool streaming = false;
+  volatile int prebuffer = 0;
+  volatile bool drainRequested = false;
+  bool pcmPrimed = false;
+  volatile uint32_t underruns = 0;
+  volatile uint32_t overruns = 0;
+
+  // Per-block output level stamped with when the block should leave the
+  // speaker: write time plus the depth of the DMA queue it joined.
+  // Written by the audio task; each field is a single 32-bit store.
+  struct RefBlock {
+    volatile uint32_t playMs;
+    volatile float meanSq;
+  };
+  static const int kDmaBufCount = 8;
+  static const int kRefBlocks = 32;   // ~680 ms of 512-frame blocks
+  RefBlock refHistory[kRefBlocks] = {};
+  uint32_t refWrite = 0;
+  void recordReference(const int16_t* pcm, int frames);
 
   bool taskRunning = false;
+  volatile bool parked = false;
   TaskHandle_t taskHandle = nullptr;
 };
@@ -1,22 +1,124 @@
 #include "DisplayService.h"
 #include "Pins.h"
+#include "Raster1bpp.h"
+#include "AssetPack.h"
 #include <Wire.h>
 
+// SSD1306 I2C control bytes and the largest payload per Wire transaction
+// (ESP32 Wire buffers 128 bytes including the control byte).
+static const uint8_t kCtrlCommand = 0x00;
+static const uint8_t kCtrlData = 0x40;
+static const int kWireChunk = 64;
+// Unchanged runs shorter than this are cheaper to resend than to split
+// into a new window (address + 7 command bytes per window).
+static const int kMinGap = 8;
+
 void DisplayService::begin() {
   Wire.begin(PIN_OLED_SDA, PIN_OLED_SCL);
+  i2cAddr = OLED_ADDR_MAIN;
   if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR_MAIN)) {
+    i2cAddr = OLED_ADDR_ALT;
     display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR_ALT);
   }
   display.clearDisplay();
   display.display();
+  Wire.setClock(400000);
+  memset(sentFrame, 0, sizeof(sentFrame));
+  if (!frontFrame) frontFrame = (uint8_t*)calloc(kBufferBytes, 1);
+  if (!frontFrame) return;
+  textCache.begin();
+  if (flushTask) return;
+  xTaskCreatePinnedToCore(flushTaskThunk, "oledFlush", 3072, this, 1, &flushTask, 0);
 }
 
 void DisplayService::beginFrame() {
   display.clearDisplay();
 }
 
-void DisplayService::endFrame() {
-  display.display();
+// Frames that arrive while the previous flush is still running are dropped
+// rather than queued: every frame is a full redraw, so the next one carries
+// the latest state anyway.
+bool DisplayService::endFrame() {
+  if (!flushTask) return false;
+  if (flushBusy) {
+    droppedFrames++;
+    return false;
+  }
+  frontFrame = display.swapBuffer(frontFrame);
+  flushBusy = true;
+  xTaskNotifyGive(flushTask);
+  return true;
+}
+
+void DisplayService::flushTaskThunk(void* arg) {
+  auto* self = reinterpret_cast<DisplayService*>(arg);
+  self->flushTaskLoop();
+}
+
+void DisplayService::flushTaskLoop() {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    flushDirty(frontFrame);
+    flushBusy = false;
+  }
+}
+
+void DisplayService::flushDirty(const uint8_t* frame) {
+  uint16_t bytes = 0;
+
+  for (uint8_t page = 0; page < kPages; ++page) {
+    const uint8_t* row = frame + page * 128;
+    uint8_t* sentRow = sentFrame + page * 128;
+
+    int col = 0;
+    while (col < 128) {
+      while (col < 128 && row[col] == sentRow[col]) col++;
+      if (col >= 128) break;
+
+      int start = col;
+      int end = col;
+      int gap = 0;
+      for (++col; col < 128 && gap < kMinGap; ++col) {
+        if (row[col] != sentRow[col]) {
+          end = col;
+          gap = 0;
+        } else {
+          gap++;
+        }
+      }
+
+      bytes += sendWindow(page, start, end, row + start);
+      memcpy(sentRow + start, row + start, end - start + 1);
+      col = end + 1;
+    }
+  }
+  flushBytes = bytes;
+}
+
+uint16_t DisplayService::sendWindow(uint8_t page, uint8_t col0, uint8_t col1, const uint8_t* data) {
+  Wire.beginTransmission(i2cAddr);
+  Wire.write(kCtrlCommand);
+  Wire.write(SSD1306_COLUMNADDR);
+  Wire.write(col0);
+  Wire.write(col1);
+  Wire.write(SSD1306_PAGEADDR);
+  Wire.write(page);
+  Wire.write(page);
+  Wire.endTransmission();
+  uint16_t bytes = 7;
+
+  int remaining = col1 - col0 + 1;
+  while (remaining > 0) {
+    int chunk = remaining > kWireChunk ? kWireChunk : remaining;
+    Wire.beginTransmission(i2cAddr);
+    Wire.write(kCtrlData);
+    Wire.write(data, chunk);
+    Wire.endTransmission();
+    bytes += chunk + 1;
+    data += chunk;
+    remaining -= chunk;
+  }
+  return bytes;
 }
 
 void DisplayService::setOffset(int8_t x, int8_t y) {
@@ -29,6 +131,7 @@ void DisplayService::clear() {
 }
 
 void DisplayService::drawText(int16_t x, int16_t y, const char* text, uint8_t size) {
+  if (textCache.drawText(display.getBuffer(), x + offsetX, y + offsetY, text, size)) return;
   display.setTextSize(size);
   display.setTextColor(SSD1306_WHITE);
   display.setCursor(x + offsetX, y + offsetY);
@@ -36,6 +139,14 @@ void DisplayService::drawText(int16_t x, int16_t y, const char* text, uint8_t si
 }
 
 void DisplayService::drawCentered(const char* text, int16_t y, uint8_t size) {
+  const TextCache::Strip* strip = textCache.strip(text, size);
+  if (strip) {
+    int16_t x = (display.width() - strip->width) / 2;
+    Raster1bpp::blitColumns(display.getBuffer(), x + offsetX, y + offsetY,
+                            strip->cols, strip->width, strip->pages);
+    return;
+  }
+
   int16_t x1, y1;
   uint16_t w, h;
   display.setTextSize(size);
@@ -47,13 +158,23 @@ void DisplayService::drawCentered(const char* text, int16_t y, uint8_t size) {
 }
 
 void DisplayService::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h) {
-  display.drawBitmap(x + offsetX, y + offsetY, bitmap, w, h, SSD1306_WHITE);
+  Raster1bpp::drawBitmap(display.getBuffer(), x + offsetX, y + offsetY, bitmap, w, h);
+}
+
+void DisplayService::drawAsset(int16_t x, int16_t y, uint16_t id) {
+  AssetPack::Asset a;
+  if (!assets || !assets->find(id, &a) || a.type != ASSET_BITMAP) return;
+  Raster1bpp::drawBitmap(display.getBuffer(), x + offsetX, y + offsetY, a.data, a.w, a.h);
 }
 
 void DisplayService::drawRect(int16_t x, int16_t y, int16_t w, int16_t h) {
-  display.drawRect(x + offsetX, y + offsetY, w, h, SSD1306_WHITE);
+  Raster1bpp::drawRect(display.getBuffer(), x + offsetX, y + offsetY, w, h);
 }
 
 void DisplayService::fillRect(int16_t x, int16_t y, int16_t w, int16_t h) {
-  display.fillRect(x + offsetX, y + offsetY, w, h, SSD1306_WHITE);
+  Raster1bpp::fillRect(display.getBuffer(), x + offsetX, y + offsetY, w, h);
+}
+
+void DisplayService::clearRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+  Raster1bpp::clearRect(display.getBuffer(), x + offsetX, y + offsetY, w, h);
 }
@@ -3,26 +3,81 @@
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "TextCache.h"
+
+class AssetPack;
 
 class DisplayService {
 public:
   void begin();
   void beginFrame();
-  void endFrame();
+  // False when the frame was dropped because the last one is still
+  // being flushed.
+  bool endFrame();
   void setOffset(int8_t x, int8_t y);
+  void setAssets(const AssetPack* pack) { assets = pack; }
 
   void clear();
   void drawText(int16_t x, int16_t y, const char* text, uint8_t size);
   void drawCentered(const char* text, int16_t y, uint8_t size);
   void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h);
+  // Draws a bitmap asset at its own size, straight from the asset pack.
+  void drawAsset(int16_t x, int16_t y, uint16_t id);
   void drawRect(int16_t x, int16_t y, int16_t w, int16_t h);
   void fillRect(int16_t x, int16_t y, int16_t w, int16_t h);
+  void clearRect(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  // The frame being drawn (SSD1306 page layout); valid until endFrame().
+  const uint8_t* frameBuffer() { return display.getBuffer(); }
+  static const int kFrameBytes = 128 * 64 / 8;
 
   int16_t width() const { return 128; }
   int16_t height() const { return 64; }
 
+  // Bytes pushed over I2C (commands + pixel data) by the last flush.
+  uint16_t lastFlushBytes() const { return flushBytes; }
+  // Frames discarded because the previous one was still being flushed.
+  uint32_t framesDropped() const { return droppedFrames; }
+  bool flushing() const { return flushBusy; }
+
 private:
-  Adafruit_SSD1306 display{128, 64, &Wire, -1};
+  static const int kPages = 64 / 8;
+  static const int kBufferBytes = kFrameBytes;
+
+  // Exposes the GFX draw target so frames can be swapped without copying.
+  // Adafruit_SSD1306 free()s `buffer` itself, so whatever is swapped in
+  // must come from malloc() too.
+  class Panel : public Adafruit_SSD1306 {
+  public:
+    using Adafruit_SSD1306::Adafruit_SSD1306;
+    uint8_t* swapBuffer(uint8_t* next) {
+      uint8_t* prev = buffer;
+      buffer = next;
+      return prev;
+    }
+  };
+
+  static void flushTaskThunk(void* arg);
+  void flushTaskLoop();
+  void flushDirty(const uint8_t* frame);
+  uint16_t sendWindow(uint8_t page, uint8_t col0, uint8_t col1, const uint8_t* data);
+
+  Panel display{128, 64, &Wire, -1};
+  TextCache textCache;
+  const AssetPack* assets = nullptr;
+  uint8_t i2cAddr = 0;
   int8_t offsetX = 0;
   int8_t offsetY = 0;
+
+  // Back buffer is whatever `display` draws into; the flush task owns the
+  // front buffer until it clears flushBusy. Both come from the heap, so
+  // whichever one `display` holds is safe for Adafruit_SSD1306 to free.
+  uint8_t* volatile frontFrame = nullptr;
+  volatile bool flushBusy = false;
+  TaskHandle_t flushTask = nullptr;
+
+  // Copy of what the panel currently shows, used to diff each frame.
+  uint8_t sentFrame[kBufferBytes];
+  volatile uint16_t flushBytes = 0;
+  volatile uint32_t droppedFrames = 0;
 };
@@ -0,0 +1,24 @@
+#include "EchoSuppressor.h"
+
+void EchoSuppressor::reset() {
+  coupling = kCouplingInit;
+}
+
+bool EchoSuppressor::update(float micMeanSq, float refMeanSq) {
+  if (!farEndActive(refMeanSq)) return false;
+
+  float ratio = micMeanSq / refMeanSq;
+  if (ratio > coupling * kDoubleTalkRatio) return true;
+
+  // Single talk: the mic is hearing the speaker. Follow quieter paths fast
+  // and louder ones slowly so a burst of near-end speech that slipped under
+  // the threshold does not inflate the estimate.
+  if (ratio < coupling) {
+    coupling += (ratio - coupling) * 0.2f;
+  } else {
+    coupling += (ratio - coupling) * 0.02f;
+  }
+  if (coupling < kCouplingMin) coupling = kCouplingMin;
+  if (coupling > kCouplingMax) coupling = kCouplingMax;
+  return false;
+}
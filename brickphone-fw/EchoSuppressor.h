@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Level-based echo suppressor with double-talk detection. It learns the
+// speaker-to-mic energy coupling while only the far end (TTS) is active
+// and flags frames whose mic energy clearly exceeds that echo estimate as
+// near-end speech. The mic path drops the rest while the speaker plays.
+class EchoSuppressor {
+public:
+  void reset();
+
+  // Feeds one frame (mean squares of mic and speaker reference) and
+  // returns true on double talk. Only meaningful while farEndActive().
+  bool update(float micMeanSq, float refMeanSq);
+  static bool farEndActive(float refMeanSq) { return refMeanSq > kFarEndMin; }
+  float couplingRatio() const { return coupling; }
+
+private:
+  static constexpr float kFarEndMin = 10000.0f;     // reference RMS ~100
+  static constexpr float kDoubleTalkRatio = 4.0f;   // 6 dB over the echo
+  static constexpr float kCouplingMin = 0.001f;
+  static constexpr float kCouplingMax = 4.0f;
+  static constexpr float kCouplingInit = 1.0f;      // assume loud until learnt
+
+  float coupling = kCouplingInit;
+};
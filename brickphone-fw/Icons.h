@@ -70,3 +70,12 @@ static const uint8_t ICON_FLAPPY_16X16[] PROGMEM = {
   0x00, 0x00, 0x1C, 0x00, 0x22, 0x00, 0x41, 0x00,
   0x22, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00
 };
+
+// 8x8 Space Invaders alien, two animation frames
+static const uint8_t SPRITE_INVADER_A_8X8[] PROGMEM = {
+  0x3C, 0x7E, 0xDB, 0xFF, 0x24, 0x5A, 0xA5, 0x42
+};
+
+static const uint8_t SPRITE_INVADER_B_8X8[] PROGMEM = {
+  0x3C, 0x7E, 0xDB, 0xFF, 0x24, 0x18, 0x5A, 0xA5
+};
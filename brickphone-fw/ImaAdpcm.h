@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+// IMA/DVI ADPCM encoder: 4 bits per sample, low nibble first. The state
+// (predictor + step index) carries across calls so consecutive frames
+// form one continuous stream; callers snapshot it into each frame header
+// so the decoder can also resync on any frame.
+class ImaAdpcmEncoder {
+public:
+  void reset();
+  int16_t predictor() const { return pred; }
+  uint8_t stepIndex() const { return index; }
+
+  // Encodes `n` samples into (n + 1) / 2 bytes; returns the byte count.
+  int encode(const int16_t* pcm, int n, uint8_t* out);
+
+private:
+  uint8_t encodeSample(int16_t sample);
+
+  int16_t pred = 0;
+  uint8_t index = 0;
+};
@@ -0,0 +1,24 @@
+#include "InputRecorder.h"
+
+static const char* const kButtonNames[BTN_COUNT] = {
+  "RIGHT", "UP", "DOWN", "LEFT", "A", "B", "SELECT", "START"
+};
+
+const char* InputRecorder::buttonName(ButtonId id) {
+  return id < BTN_COUNT ? kButtonNames[id] : "?";
+}
+
+void InputRecorder::begin(uint32_t seed, unsigned long nowMs) {
+  startMs = nowMs;
+  if (!INPUT_RECORD) return;
+  Serial.printf("seed %lu\n", (unsigned long)seed);
+}
+
+void InputRecorder::capture(const InputService& input) {
+  if (!INPUT_RECORD) return;
+  for (uint8_t n = 0; n < input.eventCount(); ++n) {
+    const InputEvent& e = input.event(n);
+    unsigned long at = (long)(e.atMs - startMs) > 0 ? e.atMs - startMs : 0;
+    Serial.printf("%lu %s %s\n", at, kButtonNames[e.id], e.pressed ? "down" : "up");
+  }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+#include "InputService.h"
+
+// 1: log every button edge over USB CDC as a host-sim input script (see
+// README, "Host Simulator"). Shares the port with the profiler's stream
+// mode, so don't use both at once.
+#define INPUT_RECORD 0
+
+// Writes "seed <n>" once, then one "<ms> <BUTTON> down|up" line per input
+// event. Times are the event timestamps counted from begin(), so
+// brickphone-sim --input reproduces the session edge for edge.
+class InputRecorder {
+public:
+  void begin(uint32_t seed, unsigned long nowMs);
+  void capture(const InputService& input);
+  static const char* buttonName(ButtonId id);
+
+private:
+  unsigned long startMs = 0;
+};
@@ -1,60 +1,102 @@
 #include "InputService.h"
+#include <soc/gpio_struct.h>
 #include "Pins.h"
 
-static const uint8_t kPins[BTN_COUNT] = {
-  PIN_BTN_RIGHT,
-  PIN_BTN_UP,
-  PIN_BTN_DOWN,
-  PIN_BTN_LEFT,
-  PIN_BTN_A,
-  PIN_BTN_B,
-  PIN_BTN_SELECT,
-  PIN_BTN_START
-};
+// The single-register scan relies on the buttons occupying GPIO35-42 in
+// ButtonId order.
+static const int kFirstPin = 35;
+static_assert(PIN_BTN_RIGHT == kFirstPin + BTN_RIGHT && PIN_BTN_UP == kFirstPin + BTN_UP &&
+              PIN_BTN_DOWN == kFirstPin + BTN_DOWN && PIN_BTN_LEFT == kFirstPin + BTN_LEFT &&
+              PIN_BTN_A == kFirstPin + BTN_A && PIN_BTN_B == kFirstPin + BTN_B &&
+              PIN_BTN_SELECT == kFirstPin + BTN_SELECT && PIN_BTN_START == kFirstPin + BTN_START,
+              "buttons must be GPIO35-42 in ButtonId order");
 
-static const unsigned long kDebounceMs = 25;
+// Active low; in1 bit 0 is GPIO32.
+static inline uint8_t readButtons() {
+  return (uint8_t)~(GPIO.in1.val >> (kFirstPin - 32));
+}
 
 void InputService::begin() {
+  queue.init(queueStorage, kQueueSize);
   for (int i = 0; i < BTN_COUNT; ++i) {
-    pinMode(kPins[i], INPUT_PULLUP);
-    bool raw = digitalRead(kPins[i]) == LOW;
-    lastStable[i] = raw;
-    lastRaw[i] = raw;
-    current[i] = raw;
-    pressedEvent[i] = false;
-    releasedEvent[i] = false;
-    lastChangeMs[i] = 0;
+    pinMode(kFirstPin + i, INPUT_PULLUP);
+  }
+  stable = readButtons();
+  count0 = 0xFF;
+  count1 = 0xFF;
+  downBits = stable;
+  pressedBits = 0;
+  releasedBits = 0;
+
+  esp_timer_create_args_t args = {};
+  args.callback = onSample;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "input";
+  args.skip_unhandled_events = true;
+  if (esp_timer_create(&args, &timer) == ESP_OK) {
+    esp_timer_start_periodic(timer, kSampleUs);
   }
 }
 
-void InputService::poll(unsigned long nowMs) {
-  for (int i = 0; i < BTN_COUNT; ++i) {
-    pressedEvent[i] = false;
-    releasedEvent[i] = false;
+void InputService::onSample(void* arg) {
+  ((InputService*)arg)->sample();
+}
 
-    bool rawPressed = digitalRead(kPins[i]) == LOW;
-    if (rawPressed != lastRaw[i]) {
-      lastRaw[i] = rawPressed;
-      lastChangeMs[i] = nowMs;
-    }
+void InputService::sample() {
+  uint8_t raw = readButtons();
 
-    if ((nowMs - lastChangeMs[i]) >= kDebounceMs && rawPressed != lastStable[i]) {
-      lastStable[i] = rawPressed;
-      if (rawPressed) pressedEvent[i] = true;
-      else releasedEvent[i] = true;
+  // Vertical counter: bits that differ from the debounced level count down
+  // from 3 in (count1, count0); any bit that agrees resets to 3. A bit
+  // whose counter wraps has held its new level for kStableSamples samples.
+  uint8_t delta = stable ^ raw;
+  count0 = ~(count0 & delta);
+  count1 = count0 ^ (count1 & delta);
+  uint8_t changed = delta & count0 & count1;
+  if (!changed) return;
+
+  int64_t firstUs = esp_timer_get_time() - (int64_t)(kStableSamples - 1) * kSampleUs;
+  unsigned long atMs = (unsigned long)((firstUs - 1) / 1000);
+  for (uint8_t id = 0; id < BTN_COUNT; ++id) {
+    uint8_t bit = 1u << id;
+    if (!(changed & bit)) continue;
+    InputEvent e = { atMs, id, (raw & bit) != 0 };
+    // Only commit the edge once it's queued. On a full queue, park the
+    // bit's counter at 0 rather than the 3 it wrapped to, so the next
+    // sample that still sees the new level wraps it again and retries.
+    if (queue.push(&e, 1) == 1) {
+      stable ^= bit;
+    } else {
+      count0 &= ~bit;
+      count1 &= ~bit;
     }
-    current[i] = lastStable[i];
   }
+  TaskHandle_t task = waiter;
+  if (task) xTaskNotifyGive(task);
 }
 
-bool InputService::pressed(ButtonId id) const {
-  return pressedEvent[id];
-}
-
-bool InputService::released(ButtonId id) const {
-  return releasedEvent[id];
+bool InputService::waitForEvent(uint32_t timeoutMs) {
+  waiter = xTaskGetCurrentTaskHandle();
+  if (queue.size() == 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+  waiter = nullptr;
+  return queue.size() > 0;
 }
 
-bool InputService::down(ButtonId id) const {
-  return current[id];
+void InputService::poll(unsigned long nowMs) {
+  (void)nowMs;
+  pressedBits = 0;
+  releasedBits = 0;
+  // Anything past kMaxBatch stays queued for the next poll.
+  batchCount = (uint8_t)queue.pop(batch, kMaxBatch);
+  for (uint8_t n = 0; n < batchCount; ++n) {
+    const InputEvent& e = batch[n];
+    uint8_t bit = 1u << e.id;
+    if (e.pressed) {
+      pressedBits |= bit;
+      downBits |= bit;
+    } else {
+      releasedBits |= bit;
+      downBits &= ~bit;
+    }
+  }
 }
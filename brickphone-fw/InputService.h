@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Arduino.h>
+#include <esp_timer.h>
+#include "SpscRing.h"
 
 enum ButtonId {
   BTN_RIGHT = 0,
@@ -14,19 +16,68 @@ enum ButtonId {
   BTN_COUNT
 };
 
+// One debounced edge. atMs is just before the first sample that saw the
+// new level, not when poll() picked it up.
+struct InputEvent {
+  unsigned long atMs;
+  uint8_t id;
+  bool pressed;
+};
+
+// A 1 kHz esp_timer samples all eight buttons with one GPIO.in1 read (they
+// sit on GPIO35-42, so bit n is ButtonId n) and debounces them together
+// with a 2-bit vertical counter per button: a level has to hold for
+// kStableSamples samples in a row before it counts. Edges are queued with
+// their timestamps, so a press is never missed while loop() is blocked
+// (e.g. in display.endFrame()), and a tap shorter than a frame still shows
+// up as a press and a release.
+//
+// poll() moves the queued events into the current batch. Screens that care
+// about order or timing walk events(); the rest use pressed()/released()/
+// down(), which are bitmasks over the same batch.
 class InputService {
 public:
   void begin();
   void poll(unsigned long nowMs);
-  bool pressed(ButtonId id) const;
-  bool released(ButtonId id) const;
-  bool down(ButtonId id) const;
+
+  // Events delivered by the latest poll(), oldest first.
+  uint8_t eventCount() const { return batchCount; }
+  const InputEvent& event(uint8_t i) const { return batch[i]; }
+
+  // Compatibility view over the batch.
+  bool pressed(ButtonId id) const { return pressedBits & (1u << id); }
+  bool released(ButtonId id) const { return releasedBits & (1u << id); }
+  bool down(ButtonId id) const { return downBits & (1u << id); }
+  bool anyDown() const { return downBits != 0; }
+
+  // Blocks the calling task until the sampler queues an event or
+  // `timeoutMs` passes. Returns whether an event is waiting for poll().
+  bool waitForEvent(uint32_t timeoutMs);
 
 private:
-  bool lastStable[BTN_COUNT];
-  bool lastRaw[BTN_COUNT];
-  bool current[BTN_COUNT];
-  bool pressedEvent[BTN_COUNT];
-  bool releasedEvent[BTN_COUNT];
-  unsigned long lastChangeMs[BTN_COUNT];
+  static const uint64_t kSampleUs = 1000;
+  static const int kStableSamples = 4;
+  static const uint32_t kQueueSize = 32;
+  static const uint8_t kMaxBatch = 16;
+
+  static void onSample(void* arg);
+  void sample();
+
+  // Sampler side, touched only by the timer callback: debounced levels
+  // (1 = pressed) and the counter's two bit-planes.
+  uint8_t stable = 0;
+  uint8_t count0 = 0xFF;
+  uint8_t count1 = 0xFF;
+
+  esp_timer_handle_t timer = nullptr;
+  TaskHandle_t volatile waiter = nullptr;
+  InputEvent queueStorage[kQueueSize];
+  SpscRing<InputEvent> queue;
+
+  // Loop side.
+  InputEvent batch[kMaxBatch];
+  uint8_t batchCount = 0;
+  uint8_t downBits = 0;
+  uint8_t pressedBits = 0;
+  uint8_t releasedBits = 0;
 };
@@ -0,0 +1,169 @@
+#include "JitterBuffer.h"
+#include "Pins.h"
+#include <esp_heap_caps.h>
+
+bool JitterBuffer::allocate(int frameSamples) {
+  if (storage) return true;
+  frameLen = frameSamples;
+  size_t bytes = (size_t)(kSlots + 1) * frameLen * sizeof(int16_t);
+  // Prefer PSRAM if available, else fallback to internal
+  storage = (int16_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!storage) {
+    storage = (int16_t*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  }
+  if (!storage) return false;
+  lastFrame = slotPcm(kSlots);
+  reset();
+  return true;
+}
+
+void JitterBuffer::release() {
+  if (storage) {
+    heap_caps_free(storage);
+    storage = nullptr;
+    lastFrame = nullptr;
+  }
+  active = false;
+}
+
+void JitterBuffer::reset() {
+  for (int i = 0; i < kSlots; ++i) slots[i].present = false;
+  active = false;
+  playing = false;
+  ending = false;
+  concealRun = 0;
+  lastSamples = 0;
+  haveTiming = false;
+}
+
+// J += (|D| - J) / 16, where D is the change in transit time between two
+// consecutive arrivals (RFC 3550 section 6.4.1). Transit is measured from
+// the worker's send time, so this is network jitter only; the worker
+// running ahead of real time does not inflate it.
+void JitterBuffer::updateJitter(uint32_t sentMs, unsigned long arrivalMs) {
+  if (haveTiming) {
+    int32_t transitDelta = (int32_t)(arrivalMs - lastArrivalMs) -
+                           (int32_t)(sentMs - lastSentMs);
+    float d = transitDelta < 0 ? -transitDelta : transitDelta;
+    jitter += (d - jitter) / 16.0f;
+  }
+  haveTiming = true;
+  lastSentMs = sentMs;
+  lastArrivalMs = arrivalMs;
+
+  float frameMs = (float)frameLen * 1000.0f / AUDIO_SAMPLE_RATE;
+  int depth = kMinDepth + (int)ceilf(2.0f * jitter / frameMs);
+  if (depth > kMaxDepth) depth = kMaxDepth;
+  target = depth;
+}
+
+void JitterBuffer::push(uint16_t seq, uint32_t sentMs, uint8_t flags,
+                        const int16_t* pcm, int samples, unsigned long arrivalMs) {
+  if (!storage || !pcm || samples <= 0 || samples > frameLen) return;
+
+  if ((flags & kFlagStart) || !active) {
+    for (int i = 0; i < kSlots; ++i) slots[i].present = false;
+    active = true;
+    playing = false;
+    ending = false;
+    concealRun = 0;
+    nextSeq = seq;
+    haveTiming = false;
+  }
+
+  int16_t ahead = (int16_t)(seq - nextSeq);
+  if (ahead < 0) {
+    late++;
+    return;
+  }
+  if (ahead >= kSlots) {
+    // Too far ahead of playout to fit. Queued frames are never discarded
+    // for it: refuse this one, unless nothing is queued (the sender's
+    // numbering jumped), in which case playout skips forward to it.
+    if (bufferedAhead() > 0) {
+      overflow++;
+      return;
+    }
+    nextSeq = seq;
+  }
+
+  updateJitter(sentMs, arrivalMs);
+
+  Slot& slot = slots[seq % kSlots];
+  slot.seq = seq;
+  slot.samples = (uint16_t)samples;
+  slot.present = true;
+  slot.end = (flags & kFlagEnd) != 0;
+  memcpy(slotPcm(seq % kSlots), pcm, samples * sizeof(int16_t));
+
+  if (slot.end) {
+    ending = true;
+    endSeq = seq;
+  }
+}
+
+int JitterBuffer::bufferedAhead() const {
+  int count = 0;
+  for (int i = 0; i < kSlots; ++i) {
+    const Slot& s = slots[(uint16_t)(nextSeq + i) % kSlots];
+    if (s.present && s.seq == (uint16_t)(nextSeq + i)) count = i + 1;
+  }
+  return count;
+}
+
+int JitterBuffer::space() const {
+  if (!storage || !active) return kSlots;
+  return kSlots - bufferedAhead();
+}
+
+JitterBuffer::PopResult JitterBuffer::pop(int16_t* out, int* samples, bool starving) {
+  if (!storage || !active) return POP_NONE;
+
+  if (!playing) {
+    if (!ending && bufferedAhead() < target) return POP_NONE;
+    playing = true;
+    concealRun = 0;
+  }
+
+  Slot& slot = slots[nextSeq % kSlots];
+  if (slot.present && slot.seq == nextSeq) {
+    memcpy(out, slotPcm(nextSeq % kSlots), slot.samples * sizeof(int16_t));
+    memcpy(lastFrame, out, slot.samples * sizeof(int16_t));
+    *samples = slot.samples;
+    lastSamples = slot.samples;
+    slot.present = false;
+    concealRun = 0;
+    nextSeq++;
+    if (slot.end) {
+      active = false;
+      playing = false;
+      return POP_END;
+    }
+    return POP_FRAME;
+  }
+
+  if (ending && (int16_t)(nextSeq - endSeq) > 0) {
+    active = false;
+    playing = false;
+    return POP_NONE;
+  }
+
+  // Missing frame: replay the last one fading towards silence, then fall
+  // back to buffering until the target depth is met again.
+  if (!starving) return POP_NONE;
+  if (concealRun >= kMaxConceal || lastSamples == 0) {
+    playing = false;
+    return POP_NONE;
+  }
+  int32_t fromQ8 = 256 * (kMaxConceal - concealRun) / kMaxConceal;
+  concealRun++;
+  int32_t toQ8 = 256 * (kMaxConceal - concealRun) / kMaxConceal;
+  for (int i = 0; i < lastSamples; ++i) {
+    int32_t gainQ8 = fromQ8 + (toQ8 - fromQ8) * i / lastSamples;
+    out[i] = (int16_t)((lastFrame[i] * gainQ8) >> 8);
+  }
+  *samples = lastSamples;
+  concealed++;
+  nextSeq++;
+  return POP_CONCEALED;
+}
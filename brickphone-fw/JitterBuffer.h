@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Reorders downlink audio frames by sequence number and releases them on a
+// playout clock driven by the caller. The target depth follows an RFC 3550
+// style jitter estimate over the frames' send times (the header `ts` is the
+// worker's clock when it sent the frame, not a media timestamp). It tracks
+// how unevenly the network delivers, so a clean link plays two frames
+// behind and a congested one buffers just enough to stay smooth. Replies
+// are sent faster than real time; the caller stops reading the socket when
+// space() runs low, so frames are never discarded to make room.
+class JitterBuffer {
+public:
+  enum PopResult {
+    POP_NONE = 0,   // nothing to play yet (buffering or idle)
+    POP_FRAME,      // `out` holds a received frame
+    POP_CONCEALED,  // `out` holds a faded repeat of the last frame
+    POP_END         // `out` holds the final frame of the stream
+  };
+
+  bool allocate(int frameSamples);
+  void release();
+  void reset();
+
+  void push(uint16_t seq, uint32_t sentMs, uint8_t flags,
+            const int16_t* pcm, int samples, unsigned long arrivalMs);
+  // `starving` tells the buffer the output is about to run dry, which is
+  // the only time a missing frame is concealed instead of waited for.
+  PopResult pop(int16_t* out, int* samples, bool starving);
+
+  // Frames that can still be pushed in order before the slots run out.
+  int space() const;
+
+  int targetFrames() const { return target; }
+  float jitterMs() const { return jitter; }
+  uint32_t lateFrames() const { return late; }
+  uint32_t concealedFrames() const { return concealed; }
+  // Frames refused because they were too far ahead of playout.
+  uint32_t overflowFrames() const { return overflow; }
+
+private:
+  static const int kSlots = 32;
+  static const int kMinDepth = 2;   // one frame playing, one in hand
+  static const int kMaxDepth = 12;
+  static const int kMaxConceal = 3;
+  static const uint8_t kFlagStart = 0x01;
+  static const uint8_t kFlagEnd = 0x02;
+
+  struct Slot {
+    uint16_t seq;
+    uint16_t samples;
+    bool present;
+    bool end;
+  };
+
+  int16_t* slotPcm(int index) const { return storage + index * frameLen; }
+  int bufferedAhead() const;
+  void updateJitter(uint32_t sentMs, unsigned long arrivalMs);
+
+  int16_t* storage = nullptr;
+  int16_t* lastFrame = nullptr;
+  int frameLen = 0;
+  Slot slots[kSlots] = {};
+
+  bool active = false;
+  bool playing = false;
+  bool ending = false;
+  uint16_t nextSeq = 0;
+  uint16_t endSeq = 0;
+  int lastSamples = 0;
+  int concealRun = 0;
+
+  bool haveTiming = false;
+  uint32_t lastSentMs = 0;
+  unsigned long lastArrivalMs = 0;
+  float jitter = 0.0f;
+  int target = kMinDepth;
+
+  uint32_t late = 0;
+  uint32_t concealed = 0;
+  uint32_t overflow = 0;
+};
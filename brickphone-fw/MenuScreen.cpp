@@ -1,18 +1,18 @@
 #include "MenuScreen.h"
 #include "DisplayService.h"
 #include "InputService.h"
-#include "Icons.h"
+#include "AssetIds.h"
 
 static const MenuScreen::Entry kEntries[] = {
-  { "Voice",   ICON_VOICE_16X16,   ScreenId::Voice },
-  { "Recorder", ICON_REC_16X16,    ScreenId::Recorder },
-  { "Snake",   ICON_SNAKE_16X16,   ScreenId::Snake },
-  { "Pong", ICON_PONG_16X16, ScreenId::Pong },
-  { "Breakout", ICON_BREAKOUT_16X16, ScreenId::Breakout },
-  { "Invaders", ICON_INVADERS_16X16, ScreenId::SpaceInvaders },
-  { "2048", ICON_2048_16X16, ScreenId::Game2048 },
-  { "Flappy", ICON_FLAPPY_16X16, ScreenId::Flappy },
-  { "Settings", ICON_SETTINGS_16X16, ScreenId::Settings }
+  { "Voice",   ASSET_ICON_VOICE,   ScreenId::Voice },
+  { "Recorder", ASSET_ICON_REC,    ScreenId::Recorder },
+  { "Snake",   ASSET_ICON_SNAKE,   ScreenId::Snake },
+  { "Pong", ASSET_ICON_PONG, ScreenId::Pong },
+  { "Breakout", ASSET_ICON_BREAKOUT, ScreenId::Breakout },
+  { "Invaders", ASSET_ICON_INVADERS, ScreenId::SpaceInvaders },
+  { "2048", ASSET_ICON_2048, ScreenId::Game2048 },
+  { "Flappy", ASSET_ICON_FLAPPY, ScreenId::Flappy },
+  { "Settings", ASSET_ICON_SETTINGS, ScreenId::Settings }
 };
 
 static const uint8_t kEntryCount = sizeof(kEntries) / sizeof(kEntries[0]);
@@ -37,7 +37,7 @@ void MenuScreen::handleInput(InputService& input) {
   if (selected >= scroll + visibleRows) scroll = selected - (visibleRows - 1);
 }
 
-void MenuScreen::render(DisplayService& display) {
+void MenuScreen::render(DisplayService& display, float) {
   display.drawText(0, 0, "BRICKPHONE", 1);
 
   const int16_t listTop = 12;
@@ -49,9 +49,9 @@ void MenuScreen::render(DisplayService& display) {
     if (idx >= kEntryCount) break;
     int16_t y = listTop + (i * rowH);
     if (idx == selected) {
-      display.drawBitmap(0, y + 3, ICON_ARROW_8X8, 8, 8);
+      display.drawAsset(0, y + 3, ASSET_ICON_ARROW);
     }
-    display.drawBitmap(10, y, kEntries[idx].icon, 16, 16);
+    display.drawAsset(10, y, kEntries[idx].icon);
     display.drawText(28, y + 4, kEntries[idx].label, 1);
   }
 
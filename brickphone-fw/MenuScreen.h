@@ -8,13 +8,14 @@ class MenuScreen : public Screen {
 public:
   struct Entry {
     const char* label;
-    const uint8_t* icon;
+    uint16_t icon;   // AssetId of a 16x16 bitmap
     ScreenId id;
   };
 
   MenuScreen(ScreenManager& screens, AudioOutService& audio);
   void handleInput(InputService& input) override;
-  void render(DisplayService& display) override;
+  void render(DisplayService& display, float alpha) override;
+  bool wantsAnimation() const override { return false; }
 
 private:
   ScreenManager& screenManager;
@@ -0,0 +1,37 @@
+#include "MicConvert.h"
+
+// Shift, saturate, store and square each sample while it is still in a
+// register. Xtensa does the min/max pair with a single CLAMPS, and a
+// square is at most 2^30, so two of them add in 32 bits before the
+// 64-bit accumulate.
+uint64_t MicConvert::convert(const int32_t* in, int16_t* out, int n) {
+  uint64_t sumSq = 0;
+  int i = 0;
+  for (; i + 1 < n; i += 2) {
+    int32_t a = in[i] >> 14;
+    int32_t b = in[i + 1] >> 14;
+    if (a > 32767) a = 32767;
+    if (a < -32768) a = -32768;
+    if (b > 32767) b = 32767;
+    if (b < -32768) b = -32768;
+    out[i] = (int16_t)a;
+    out[i + 1] = (int16_t)b;
+    sumSq += (uint32_t)(a * a) + (uint32_t)(b * b);
+  }
+  if (i < n) {
+    int32_t a = in[i] >> 14;
+    if (a > 32767) a = 32767;
+    if (a < -32768) a = -32768;
+    out[i] = (int16_t)a;
+    sumSq += (uint32_t)(a * a);
+  }
+  return sumSq;
+}
+
+int MicConvert::zeroCrossings(const int16_t* pcm, int n) {
+  int crossings = 0;
+  for (int i = 1; i < n; ++i) {
+    crossings += (pcm[i - 1] ^ pcm[i]) < 0;
+  }
+  return crossings;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Mic sample kernels. The INMP441 delivers 24-bit samples left-justified in
+// 32-bit I2S slots; `>> 14` keeps some headroom above the usual 16-bit cut
+// and the result is saturated rather than wrapped.
+class MicConvert {
+public:
+  // Converts `n` slots to PCM16 and returns the sum of squares of the
+  // converted samples, in one pass over the block.
+  static uint64_t convert(const int32_t* in, int16_t* out, int n);
+
+  // Sign changes between neighbouring samples.
+  static int zeroCrossings(const int16_t* pcm, int n);
+};
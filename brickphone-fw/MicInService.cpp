@@ -1,11 +1,35 @@
 #include "MicInService.h"
+#include "MicConvert.h"
 #include "Pins.h"
+#include "StorageService.h"
 #include "driver/i2s.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <math.h>
 
 #define I2S_IN_PORT I2S_NUM_0
 
+// The DMA keeps capturing while a flash operation stalls the capture task,
+// so its ring must outlast one. Recording is what writes flash.
+static const int kDmaBufCount = 8;
+static_assert(kDmaBufCount * AUDIO_FRAMES * 1000 / AUDIO_SAMPLE_RATE >= StorageService::kFlashStallMs,
+              "mic DMA ring shorter than a flash stall");
+
 void MicInService::begin() {
+  if (taskHandle) return;
+  if (!ringStorage) {
+    ringStorage = (Block*)heap_caps_malloc(kRingBlocks * sizeof(Block),
+                                           MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ringStorage) {
+      ring.init(ringStorage, kRingBlocks);
+    } else {
+      ringStorage = (Block*)heap_caps_malloc(kRingBlocksInternal * sizeof(Block),
+                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+      if (!ringStorage) return;
+      ring.init(ringStorage, kRingBlocksInternal);
+    }
+  }
+
   i2s_config_t cfg = {
     .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
     .sample_rate = AUDIO_SAMPLE_RATE,
@@ -15,7 +39,7 @@ void MicInService::begin() {
       I2S_COMM_FORMAT_I2S | I2S_COMM_FORMAT_I2S_MSB
     ),
     .intr_alloc_flags = 0,
-    .dma_buf_count = 8,
+    .dma_buf_count = kDmaBufCount,
     .dma_buf_len = AUDIO_FRAMES,
     .use_apll = false,
     .tx_desc_auto_clear = false,
@@ -32,38 +56,127 @@ void MicInService::begin() {
   i2s_driver_install(I2S_IN_PORT, &cfg, 0, NULL);
   i2s_set_pin(I2S_IN_PORT, &pins);
   i2s_set_clk(I2S_IN_PORT, AUDIO_SAMPLE_RATE, I2S_BITS_PER_SAMPLE_32BIT, I2S_CHANNEL_MONO);
+
+  // Same core as the UI loop but above it, so a long display frame or
+  // WebSocket send can no longer leave the DMA queue to overflow.
+  xTaskCreatePinnedToCore(captureTaskThunk, "micIn", 3072, this, 3, &taskHandle, 1);
 }
 
 void MicInService::tick(unsigned long) {
   if (currentMode == MIC_OFF) return;
 }
 
+// Called from the consumer side; stale audio captured under the previous
+// mode is dropped so a new recording starts from "now".
 void MicInService::setMode(MicMode mode) {
+  if (mode == currentMode) return;
   currentMode = mode;
+  ring.discard();
+  currentPos = kBlockFrames;
+  if (mode == MIC_OFF) lastMeanSq = 0.0f;
+}
+
+// The capture task only stores the mean square; the root is taken here at
+// UI rate instead of for every block.
+float MicInService::rmsLevel() const {
+  return sqrtf(lastMeanSq) / 32768.0f;
+}
+
+int MicInService::queuedFrames() const {
+  return (kBlockFrames - currentPos) + (int)ring.size() * kBlockFrames;
 }
 
-bool MicInService::readPcm16(int16_t* outBuf, int frames) {
+bool MicInService::readPcm16(int16_t* outBuf, int frames, MicFrameInfo* info) {
   if (!outBuf || frames <= 0) return false;
+  if (queuedFrames() < frames) return false;
 
-  static int32_t in32[AUDIO_FRAMES];
-  if (frames > AUDIO_FRAMES) frames = AUDIO_FRAMES;
-  size_t nbytes = 0;
+  int copied = 0;
+  int blocks = 0;
+  float energy = 0.0f;
+  while (copied < frames) {
+    if (currentPos >= kBlockFrames) {
+      if (ring.pop(&current, 1) == 0) break;
+      currentPos = 0;
+    }
+    if (info) {
+      if (copied == 0) {
+        info->captureUs = current.captureUs +
+                          (int64_t)currentPos * 1000000 / AUDIO_SAMPLE_RATE;
+        info->voiced = false;
+      }
+      if (current.voiced) info->voiced = true;
+      energy += current.meanSq;
+      blocks++;
+    }
+    int n = kBlockFrames - currentPos;
+    if (n > frames - copied) n = frames - copied;
+    memcpy(outBuf + copied, current.pcm + currentPos, n * sizeof(int16_t));
+    copied += n;
+    currentPos += n;
+  }
+  if (info && blocks > 0) info->meanSq = energy / blocks;
+  return copied == frames;
+}
+
+void MicInService::captureTaskThunk(void* arg) {
+  auto* self = reinterpret_cast<MicInService*>(arg);
+  self->captureTaskLoop();
+}
 
-  if (i2s_read(I2S_IN_PORT, in32, frames * sizeof(int32_t), &nbytes, 0) != ESP_OK ||
-      nbytes != (size_t)(frames * sizeof(int32_t))) {
-    return false;
+bool MicInService::updateVad(float meanSq, int crossings) {
+  bool candidate = meanSq > noiseFloor * kVadLoudRatio ||
+                   (meanSq > noiseFloor * kVadSoftRatio &&
+                    crossings >= kVadFricativeCrossings);
+
+  if (candidate) {
+    if (vadOnset < kVadOnsetBlocks) vadOnset++;
+  } else {
+    vadOnset = 0;
+    // Track the floor quickly downwards and slowly (~2.5 s) upwards, and
+    // only from blocks that do not look like speech.
+    if (meanSq < noiseFloor) {
+      noiseFloor += (meanSq - noiseFloor) * 0.25f;
+    } else {
+      noiseFloor += (meanSq - noiseFloor) * (1.0f / 256.0f);
+    }
+    if (noiseFloor < kVadMinFloor) noiseFloor = kVadMinFloor;
   }
 
-  int64_t sumSq = 0;
-  for (int i = 0; i < frames; ++i) {
-    int16_t s = (int16_t)(in32[i] >> 14);
-    outBuf[i] = s;
-    sumSq += (int32_t)s * (int32_t)s;
+  if (vadOnset >= kVadOnsetBlocks) {
+    vadHangover = kVadHangoverBlocks;
+  } else if (vadHangover > 0) {
+    vadHangover--;
   }
+  return vadHangover > 0;
+}
+
+// Drains the I2S DMA queue continuously. While the mic is off the blocks
+// are read and thrown away so the queue never holds stale audio.
+void MicInService::captureTaskLoop() {
+  const int64_t blockUs = (int64_t)kBlockFrames * 1000000 / AUDIO_SAMPLE_RATE;
+  for (;;) {
+    size_t nbytes = 0;
+    if (i2s_read(I2S_IN_PORT, in32, sizeof(in32), &nbytes, portMAX_DELAY) != ESP_OK ||
+        nbytes != sizeof(in32)) {
+      continue;
+    }
+    int64_t now = esp_timer_get_time();
+    if (currentMode == MIC_OFF) {
+      vadOnset = 0;
+      vadHangover = 0;
+      vadVoiced = false;
+      continue;
+    }
+
+    staging.captureUs = now - blockUs;
+    uint64_t sumSq = MicConvert::convert(in32, staging.pcm, kBlockFrames);
+    float meanSq = (float)sumSq / (float)kBlockFrames;
+    lastMeanSq = meanSq;
+    staging.meanSq = meanSq;
+    int crossings = MicConvert::zeroCrossings(staging.pcm, kBlockFrames);
+    staging.voiced = updateVad(meanSq, crossings);
+    vadVoiced = staging.voiced;
 
-  if (frames > 0) {
-    float meanSq = (float)sumSq / (float)frames;
-    lastRms = sqrtf(meanSq) / 32768.0f;
+    if (ring.push(&staging, 1) == 0) droppedBlocks++;
   }
-  return true;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include "SpscRing.h"
 
 enum MicMode {
   MIC_OFF = 0,
@@ -9,6 +10,12 @@ enum MicMode {
   MIC_LOCAL_RECORD
 };
 
+struct MicFrameInfo {
+  int64_t captureUs = 0;  // esp_timer time of the first sample
+  bool voiced = false;    // VAD marked any block in the span as speech
+  float meanSq = 0.0f;    // average block energy over the span
+};
+
 class MicInService {
 public:
   void begin();
@@ -16,10 +23,63 @@ public:
   void setMode(MicMode mode);
   MicMode mode() const { return currentMode; }
 
-  bool readPcm16(int16_t* outBuf, int frames);
-  float rmsLevel() const { return lastRms; }
+  // Pulls `frames` samples from the capture ring. Returns false (and
+  // consumes nothing) until that many are queued. `info`, if given,
+  // receives the capture time and the VAD decision for the span.
+  bool readPcm16(int16_t* outBuf, int frames, MicFrameInfo* info = nullptr);
+  int queuedFrames() const;
+  float rmsLevel() const;
+  // Latest VAD decision, hangover included.
+  bool voiceActive() const { return vadVoiced; }
+  uint32_t overruns() const { return droppedBlocks; }
 
 private:
-  MicMode currentMode = MIC_OFF;
-  float lastRms = 0.0f;
+  // 10 ms at 24 kHz; the capture task reads, converts and stamps one block
+  // at a time.
+  static const int kBlockFrames = 240;
+  struct Block {
+    int64_t captureUs;
+    int16_t pcm[kBlockFrames];
+    float meanSq;
+    bool voiced;
+  };
+  // ~640 ms of audio when PSRAM is available, else 160 ms of internal RAM.
+  static const int kRingBlocks = 64;
+  static const int kRingBlocksInternal = 16;
+
+  // VAD: a block is a speech candidate when its energy clears the noise
+  // floor by kVadLoudRatio, or by kVadSoftRatio with a fricative-like
+  // zero-crossing count. kVadOnsetBlocks candidates in a row open speech;
+  // it closes after kVadHangoverBlocks without one.
+  static constexpr float kVadLoudRatio = 8.0f;
+  static constexpr float kVadSoftRatio = 2.5f;
+  static constexpr float kVadMinFloor = 100.0f;   // mean square, ~RMS 10
+  static const int kVadFricativeCrossings = kBlockFrames / 4;
+  static const int kVadOnsetBlocks = 2;
+  static const int kVadHangoverBlocks = 30;
+
+  static void captureTaskThunk(void* arg);
+  void captureTaskLoop();
+  bool updateVad(float meanSq, int crossings);
+
+  volatile MicMode currentMode = MIC_OFF;
+  volatile float lastMeanSq = 0.0f;
+  volatile uint32_t droppedBlocks = 0;
+
+  // Capture-task VAD state; the noise floor survives mode changes.
+  float noiseFloor = 10000.0f;
+  int vadOnset = 0;
+  int vadHangover = 0;
+  volatile bool vadVoiced = false;
+
+  Block* ringStorage = nullptr;
+  SpscRing<Block> ring;
+  int32_t in32[kBlockFrames];
+  Block staging;
+
+  // Consumer-side partially read block.
+  Block current;
+  int currentPos = kBlockFrames;
+
+  TaskHandle_t taskHandle = nullptr;
 };
@@ -8,6 +8,7 @@ public:
   void tick(unsigned long nowMs);
   void connectWifi(const char* ssid, const char* pass);
   bool isConnected() const;
+  bool isConnecting() const { return connecting; }
 
   void sendAudioFrame(const int16_t* pcm, int frames);
   void sendEvent(const char* type, const char* payload);
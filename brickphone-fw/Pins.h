@@ -29,3 +29,5 @@
 // ---------------- AUDIO STANDARD --------
 #define AUDIO_SAMPLE_RATE 24000
 #define AUDIO_FRAMES       512
+// 1: drive the MAX98357 with a single I2S slot (no mono->stereo copy)
+#define AUDIO_OUT_MONO     1
@@ -0,0 +1,98 @@
+#include "PowerService.h"
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include "AudioOutService.h"
+#include "DisplayService.h"
+#include "InputService.h"
+#include "MicInService.h"
+#include "NetService.h"
+#include "Pins.h"
+#include "Profiler.h"
+#include "ScreenManager.h"
+#include "StorageService.h"
+
+static const uint8_t kWakePins[] = {
+  PIN_BTN_RIGHT, PIN_BTN_UP, PIN_BTN_DOWN, PIN_BTN_LEFT,
+  PIN_BTN_A, PIN_BTN_B, PIN_BTN_SELECT, PIN_BTN_START
+};
+
+PowerService::PowerService(ScreenManager& screens, InputService& input, DisplayService& display,
+                           AudioOutService& audio, MicInService& mic, StorageService& store,
+                           NetService& net, Profiler& prof)
+    : screenManager(screens),
+      inputService(input),
+      displayService(display),
+      audioOut(audio),
+      micIn(mic),
+      storage(store),
+      netService(net),
+      profiler(prof) {}
+
+void PowerService::begin() {
+#if IDLE_LIGHT_SLEEP
+  // Buttons pull their pin low, so any press wakes the chip.
+  for (uint8_t pin : kWakePins) gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+#endif
+  lastBusyMs = millis();
+}
+
+void PowerService::update(unsigned long nowMs) {
+  bool wasAnimating = animating;
+  animating = screenManager.wantsAnimation() || profiler.active();
+  bool gotInput = inputService.eventCount() > 0;
+  uint8_t services = (audioOut.isIdle() ? 0 : 1) | (micIn.mode() != MIC_OFF ? 2 : 0) |
+                     (storage.writerOpen() ? 4 : 0) | (netService.isConnecting() ? 8 : 0) |
+                     (netService.isConnected() ? 16 : 0);
+  busy = animating || gotInput || inputService.anyDown() || (services & 15);
+  if (busy) lastBusyMs = nowMs;
+  if (gotInput || (int)screenManager.currentId() != shownScreen) redrawPending = true;
+  // Still screens show service state too (Settings' link status, the
+  // Recorder's idle view once playback ends), and a screen that just
+  // stopped animating owes one frame of its final state. Neither should
+  // wait for the idle frame.
+  if (services != serviceState || (wasAnimating && !animating)) redrawPending = true;
+  serviceState = services;
+}
+
+bool PowerService::frameDue(unsigned long nowMs) const {
+  unsigned long interval = (animating || redrawPending) ? kFrameMs : kIdleFrameMs;
+  return nowMs - lastFrameMs >= interval;
+}
+
+void PowerService::frameDone(unsigned long nowMs, bool shown) {
+  lastFrameMs = nowMs;
+  if (!shown) return;
+  redrawPending = false;
+  shownScreen = (int)screenManager.currentId();
+}
+
+void PowerService::rest(unsigned long nowMs) {
+  if (busy || redrawPending) return;
+#if IDLE_LIGHT_SLEEP
+  if (nowMs - lastBusyMs >= kSleepAfterMs && canSleep()) {
+    lightSleep(nowMs);
+    return;
+  }
+#endif
+  unsigned long sinceFrame = nowMs - lastFrameMs;
+  unsigned long wait = kIdleWaitMs;
+  if (sinceFrame >= kIdleFrameMs) return;
+  if (kIdleFrameMs - sinceFrame < wait) wait = kIdleFrameMs - sinceFrame;
+  inputService.waitForEvent(wait);
+}
+
+// Light sleep stops the I2C flush and drops the Wi-Fi link, so wait for
+// the first and don't break the second.
+bool PowerService::canSleep() const {
+  return !displayService.flushing() && !netService.isConnected();
+}
+
+void PowerService::lightSleep(unsigned long nowMs) {
+  unsigned long sinceFrame = nowMs - lastFrameMs;
+  unsigned long untilFrame = sinceFrame < kIdleFrameMs ? kIdleFrameMs - sinceFrame : 1;
+  esp_sleep_enable_timer_wakeup((uint64_t)untilFrame * 1000);
+  esp_light_sleep_start();
+  // Stay up while the press debounces and the screen answers it.
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) lastBusyMs = millis();
+}
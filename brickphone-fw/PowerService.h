@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+
+class ScreenManager;
+class InputService;
+class DisplayService;
+class AudioOutService;
+class MicInService;
+class StorageService;
+class NetService;
+class Profiler;
+
+// 1: light-sleep once the device has sat idle for kSleepAfterMs. The USB
+// serial console drops while asleep, so set 0 when debugging over it.
+#define IDLE_LIGHT_SLEEP 1
+
+// Idle governor. The loop runs flat out (a frame every kFrameMs) while the
+// screen animates or anything is in flight: audio, mic, a file write,
+// Wi-Fi, a held button, the profiler. Otherwise:
+//  - frames are drawn only after input or a service state change (audio,
+//    mic, writer, Wi-Fi), or every kIdleFrameMs;
+//  - rest() parks the loop task until the next input event;
+//  - after kSleepAfterMs of that, rest() light-sleeps the chip until a
+//    button goes down (GPIO wake) or the next idle frame.
+class PowerService {
+public:
+  PowerService(ScreenManager& screens, InputService& input, DisplayService& display,
+               AudioOutService& audio, MicInService& mic, StorageService& store,
+               NetService& net, Profiler& prof);
+  void begin();
+  // Once per loop, after the screen tick.
+  void update(unsigned long nowMs);
+  bool frameDue(unsigned long nowMs) const;
+  // `shown` is endFrame()'s result; a dropped frame is retried.
+  void frameDone(unsigned long nowMs, bool shown);
+  // End of loop(): returns at once while busy.
+  void rest(unsigned long nowMs);
+  bool idle() const { return !busy; }
+
+  static const unsigned long kFrameMs = 33;
+  static const unsigned long kIdleFrameMs = 1000;
+  static const unsigned long kSleepAfterMs = 5000;
+  // Longest the loop parks while awake, so service ticks still run.
+  static const unsigned long kIdleWaitMs = 50;
+
+private:
+  bool canSleep() const;
+  void lightSleep(unsigned long nowMs);
+
+  ScreenManager& screenManager;
+  InputService& inputService;
+  DisplayService& displayService;
+  AudioOutService& audioOut;
+  MicInService& micIn;
+  StorageService& storage;
+  NetService& netService;
+  Profiler& profiler;
+
+  bool animating = true;
+  bool busy = true;
+  bool redrawPending = true;
+  // Service flags as of the last update(); a change forces a redraw.
+  uint8_t serviceState = 0;
+  int shownScreen = -1;
+  unsigned long lastBusyMs = 0;
+  unsigned long lastFrameMs = 0;
+};
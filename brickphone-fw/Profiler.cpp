@@ -0,0 +1,150 @@
+#include "Profiler.h"
+#include "DisplayService.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+static const char* const kStageNames[STAGE_COUNT] = {
+  "LOOP", "INPT", "SVC", "HNDL", "FIXD", "TICK", "DRAW", "ENDF"
+};
+
+void Profiler::begin() {
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  cyclesPerUs = mhz ? mhz : 240;
+  resetWindows();
+}
+
+void Profiler::cycleMode() {
+  currentMode = (ProfMode)((currentMode + 1) % (PROF_STREAM + 1));
+  memset(report, 0, sizeof(report));
+  resetWindows();
+}
+
+void Profiler::resetWindows() {
+  memset(windows, 0, sizeof(windows));
+  for (int s = 0; s < STAGE_COUNT; ++s) windows[s].minCycles = UINT32_MAX;
+  windowStartMs = millis();
+}
+
+// Four buckets per power of two (~19% wide); 0..3 cycles map to themselves.
+int Profiler::bucketFor(uint32_t cycles) {
+  if (cycles < 4) return (int)cycles;
+  int octave = 31 - __builtin_clz(cycles);
+  return octave * 4 + (int)((cycles >> (octave - 2)) & 3);
+}
+
+uint32_t Profiler::bucketUpper(int bucket) {
+  if (bucket < 4) return (uint32_t)bucket;
+  int octave = bucket / 4;
+  uint32_t width = 1u << (octave - 2);
+  return (uint32_t)(4 + bucket % 4) * width + (width - 1);
+}
+
+void Profiler::record(ProfStage stage, uint32_t cycles) {
+  Window& w = windows[stage];
+  w.hist[bucketFor(cycles)]++;
+  w.count++;
+  w.sumCycles += cycles;
+  if (cycles < w.minCycles) w.minCycles = cycles;
+  if (cycles > w.maxCycles) w.maxCycles = cycles;
+}
+
+void Profiler::tick(unsigned long nowMs) {
+  if (!active() || nowMs - windowStartMs < kWindowMs) return;
+  publish(nowMs);
+  if (currentMode == PROF_STREAM) sendReport(nowMs);
+  resetWindows();
+}
+
+void Profiler::publish(unsigned long nowMs) {
+  for (int s = 0; s < STAGE_COUNT; ++s) {
+    const Window& w = windows[s];
+    StageStats& out = report[s];
+    out.count = w.count;
+    if (w.count == 0) {
+      out.minUs = out.avgUs = out.p99Us = out.maxUs = 0;
+      continue;
+    }
+    // p99 is the upper edge of the bucket holding the 99th percentile
+    // sample, clamped to the true maximum.
+    uint32_t target = w.count - w.count / 100;
+    uint32_t seen = 0;
+    uint32_t p99 = w.maxCycles;
+    for (int b = 0; b < kBuckets; ++b) {
+      seen += w.hist[b];
+      if (seen >= target) {
+        p99 = bucketUpper(b);
+        break;
+      }
+    }
+    if (p99 > w.maxCycles) p99 = w.maxCycles;
+    out.minUs = w.minCycles / cyclesPerUs;
+    out.avgUs = (uint32_t)(w.sumCycles / w.count / cyclesPerUs);
+    out.p99Us = p99 / cyclesPerUs;
+    out.maxUs = w.maxCycles / cyclesPerUs;
+  }
+
+  heapFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  heapMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+  psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  psramMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+  // ESP-IDF reports the high-water mark in bytes.
+  loopStackFree = uxTaskGetStackHighWaterMark(nullptr);
+}
+
+// Dropped rather than blocking the loop when the host isn't draining CDC.
+void Profiler::sendReport(unsigned long nowMs) {
+  uint8_t packet[sizeof(ReportHeader) + sizeof(report) + 1];
+  ReportHeader header;
+  header.magic = kReportMagic;
+  header.version = kReportVersion;
+  header.stageCount = STAGE_COUNT;
+  header.uptimeMs = (uint32_t)nowMs;
+  header.heapFree = heapFree;
+  header.heapMinFree = heapMinFree;
+  header.psramFree = psramFree;
+  header.psramMinFree = psramMinFree;
+  header.loopStackFree = loopStackFree;
+  memcpy(packet, &header, sizeof(header));
+  memcpy(packet + sizeof(header), report, sizeof(report));
+
+  uint8_t check = 0;
+  for (size_t i = 0; i < sizeof(packet) - 1; ++i) check ^= packet[i];
+  packet[sizeof(packet) - 1] = check;
+
+  if (Serial.availableForWrite() < (int)sizeof(packet)) return;
+  Serial.write(packet, sizeof(packet));
+}
+
+// Full-screen pane: one "NAME min avg p99" row (us) per stage, then
+// internal heap free/low-water and PSRAM low-water in KB. HNDL is only in
+// the stream.
+void Profiler::drawOverlay(DisplayService& display) const {
+  if (currentMode != PROF_OVERLAY) return;
+  display.clearRect(0, 0, display.width(), display.height());
+
+  static const ProfStage kShown[] = {
+    STAGE_LOOP, STAGE_INPUT, STAGE_SERVICES, STAGE_FIXED_UPDATE,
+    STAGE_SCREEN_TICK, STAGE_RENDER, STAGE_END_FRAME
+  };
+  char line[24];
+  int16_t y = 0;
+  for (ProfStage s : kShown) {
+    const StageStats& st = report[s];
+    snprintf(line, sizeof(line), "%-4s%5lu%6lu%6lu", kStageNames[s],
+             (unsigned long)(st.minUs > 99999 ? 99999 : st.minUs),
+             (unsigned long)(st.avgUs > 99999 ? 99999 : st.avgUs),
+             (unsigned long)(st.p99Us > 99999 ? 99999 : st.p99Us));
+    display.drawText(0, y, line, 1);
+    y += 8;
+  }
+  // Clamped to the field widths, like the stage columns, so the line
+  // always fits the buffer and the 21-column panel.
+  uint32_t heapKb = heapFree / 1024;
+  uint32_t heapMinKb = heapMinFree / 1024;
+  uint32_t psramMinKb = psramMinFree / 1024;
+  snprintf(line, sizeof(line), "H%3lu/%3luk P%4luk",
+           (unsigned long)(heapKb > 999 ? 999 : heapKb),
+           (unsigned long)(heapMinKb > 999 ? 999 : heapMinKb),
+           (unsigned long)(psramMinKb > 9999 ? 9999 : psramMinKb));
+  display.drawText(0, y, line, 1);
+}
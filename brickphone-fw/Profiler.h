@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+
+class DisplayService;
+
+enum ProfMode : uint8_t {
+  PROF_OFF = 0,
+  PROF_OVERLAY,   // stats pane drawn over the current screen
+  PROF_STREAM     // binary report over USB CDC once per window
+};
+
+// loop() stages plus each Screen virtual call made by ScreenManager.
+enum ProfStage : uint8_t {
+  STAGE_LOOP = 0,
+  STAGE_INPUT,
+  STAGE_SERVICES,
+  STAGE_HANDLE_INPUT,
+  STAGE_FIXED_UPDATE,
+  STAGE_SCREEN_TICK,
+  STAGE_RENDER,
+  STAGE_END_FRAME,
+  STAGE_COUNT
+};
+
+// Cycle-counter timings of the main loop. Each stage feeds a histogram of
+// quarter-octave buckets, so recording is a couple of adds; once a second
+// the window is folded into min/avg/p99/max and heap watermarks are
+// sampled. Everything runs on the loop task.
+class Profiler {
+public:
+  static const uint16_t kReportMagic = 0x4650;   // "PF"
+  static const uint8_t kReportVersion = 1;
+
+  struct StageStats {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t avgUs;
+    uint32_t p99Us;
+    uint32_t maxUs;
+  };
+
+  // Stream packet; little-endian, followed by STAGE_COUNT StageStats and
+  // an XOR of all preceding bytes.
+  struct __attribute__((packed)) ReportHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t stageCount;
+    uint32_t uptimeMs;
+    uint32_t heapFree;
+    uint32_t heapMinFree;
+    uint32_t psramFree;
+    uint32_t psramMinFree;
+    uint32_t loopStackFree;
+  };
+
+  void begin();
+  // OFF -> OVERLAY -> STREAM -> OFF.
+  void cycleMode();
+  ProfMode mode() const { return currentMode; }
+  bool active() const { return currentMode != PROF_OFF; }
+
+  void record(ProfStage stage, uint32_t cycles);
+  void tick(unsigned long nowMs);
+  void drawOverlay(DisplayService& display) const;
+  const StageStats& stats(ProfStage stage) const { return report[stage]; }
+
+private:
+  static const unsigned long kWindowMs = 1000;
+  static const int kBuckets = 128;
+
+  struct Window {
+    uint32_t hist[kBuckets];
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t sumCycles;
+  };
+
+  static int bucketFor(uint32_t cycles);
+  static uint32_t bucketUpper(int bucket);
+  void resetWindows();
+  void publish(unsigned long nowMs);
+  void sendReport(unsigned long nowMs);
+
+  ProfMode currentMode = PROF_OFF;
+  uint32_t cyclesPerUs = 240;
+  unsigned long windowStartMs = 0;
+  Window windows[STAGE_COUNT];
+  StageStats report[STAGE_COUNT] = {};
+  uint32_t heapFree = 0;
+  uint32_t heapMinFree = 0;
+  uint32_t psramFree = 0;
+  uint32_t psramMinFree = 0;
+  uint32_t loopStackFree = 0;
+};
+
+// Times the enclosing scope into `stage`; a null or idle profiler costs one
+// branch.
+class ProfScope {
+public:
+  ProfScope(Profiler* profiler, ProfStage stage)
+    : prof(profiler && profiler->active() ? profiler : nullptr),
+      stageId(stage),
+      start(prof ? ESP.getCycleCount() : 0) {}
+  ~ProfScope() {
+    if (prof) prof->record(stageId, ESP.getCycleCount() - start);
+  }
+  ProfScope(const ProfScope&) = delete;
+  ProfScope& operator=(const ProfScope&) = delete;
+
+private:
+  Profiler* prof;
+  ProfStage stageId;
+  uint32_t start;
+};
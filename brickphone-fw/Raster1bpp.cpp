@@ -0,0 +1,128 @@
+#include "Raster1bpp.h"
+
+typedef uint32_t __attribute__((may_alias)) RasterWord;
+
+void Raster1bpp::orSpan(uint8_t* row, int16_t x0, int16_t x1, uint8_t mask) {
+  uint8_t* p = row + x0;
+  uint8_t* end = row + x1 + 1;
+
+  while (p < end && ((uintptr_t)p & 3)) *p++ |= mask;
+
+  uint32_t mask32 = mask * 0x01010101u;
+  while (end - p >= 4) {
+    *reinterpret_cast<RasterWord*>(p) |= mask32;
+    p += 4;
+  }
+
+  while (p < end) *p++ |= mask;
+}
+
+void Raster1bpp::fillRect(uint8_t* fb, int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) return;
+  int16_t x0 = x < 0 ? 0 : x;
+  int16_t y0 = y < 0 ? 0 : y;
+  int16_t x1 = (x + w > kWidth ? kWidth : x + w) - 1;
+  int16_t y1 = (y + h > kHeight ? kHeight : y + h) - 1;
+  if (x0 > x1 || y0 > y1) return;
+
+  int16_t page0 = y0 >> 3;
+  int16_t page1 = y1 >> 3;
+  for (int16_t page = page0; page <= page1; ++page) {
+    uint8_t mask = 0xFF;
+    if (page == page0) mask &= (uint8_t)(0xFF << (y0 & 7));
+    if (page == page1) mask &= (uint8_t)(0xFF >> (7 - (y1 & 7)));
+    orSpan(fb + page * kWidth, x0, x1, mask);
+  }
+}
+
+// Debug overlays only, so a plain byte loop.
+void Raster1bpp::clearRect(uint8_t* fb, int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) return;
+  int16_t x0 = x < 0 ? 0 : x;
+  int16_t y0 = y < 0 ? 0 : y;
+  int16_t x1 = (x + w > kWidth ? kWidth : x + w) - 1;
+  int16_t y1 = (y + h > kHeight ? kHeight : y + h) - 1;
+  if (x0 > x1 || y0 > y1) return;
+
+  int16_t page0 = y0 >> 3;
+  int16_t page1 = y1 >> 3;
+  for (int16_t page = page0; page <= page1; ++page) {
+    uint8_t mask = 0xFF;
+    if (page == page0) mask &= (uint8_t)(0xFF << (y0 & 7));
+    if (page == page1) mask &= (uint8_t)(0xFF >> (7 - (y1 & 7)));
+    uint8_t* row = fb + page * kWidth;
+    for (int16_t col = x0; col <= x1; ++col) row[col] &= (uint8_t)~mask;
+  }
+}
+
+void Raster1bpp::drawRect(uint8_t* fb, int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) return;
+  fillRect(fb, x, y, w, 1);
+  fillRect(fb, x, y + h - 1, w, 1);
+  fillRect(fb, x, y, 1, h);
+  fillRect(fb, x + w - 1, y, 1, h);
+}
+
+// ORs an 8-pixel column whose top pixel lands on row y, splitting it across
+// the two pages it straddles.
+void Raster1bpp::orColumn(uint8_t* fb, int16_t x, int16_t y, uint8_t bits) {
+  int16_t page = y >> 3;
+  uint8_t shift = y & 7;
+  if (page >= 0 && page < kHeight / 8) {
+    fb[page * kWidth + x] |= (uint8_t)(bits << shift);
+  }
+  if (shift && page + 1 >= 0 && page + 1 < kHeight / 8) {
+    fb[(page + 1) * kWidth + x] |= (uint8_t)(bits >> (8 - shift));
+  }
+}
+
+void Raster1bpp::drawBitmap(uint8_t* fb, int16_t x, int16_t y,
+                            const uint8_t* bitmap, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) return;
+  if (x >= kWidth || y >= kHeight || x + w <= 0 || y + h <= 0) return;
+
+  int16_t byteWidth = (w + 7) / 8;
+  int16_t cx0 = x < 0 ? -x : 0;
+  int16_t cx1 = (x + w > kWidth ? kWidth - x : w) - 1;
+
+  for (int16_t band = 0; band < h; band += 8) {
+    int16_t bandRows = (h - band) < 8 ? (h - band) : 8;
+    int16_t dy = y + band;
+    if (dy + bandRows <= 0 || dy >= kHeight) continue;
+
+    // Transpose this 8-row band one source byte (8 columns) at a time.
+    for (int16_t bx = cx0 >> 3; bx <= cx1 >> 3; ++bx) {
+      uint8_t cols[8] = {};
+      for (int16_t r = 0; r < bandRows; ++r) {
+        uint8_t src = pgm_read_byte(&bitmap[(band + r) * byteWidth + bx]);
+        if (!src) continue;
+        for (uint8_t b = 0; b < 8; ++b) {
+          if (src & (0x80 >> b)) cols[b] |= (uint8_t)(1 << r);
+        }
+      }
+
+      int16_t c0 = bx * 8;
+      for (uint8_t b = 0; b < 8; ++b) {
+        int16_t cx = c0 + b;
+        if (cx < cx0 || cx > cx1 || !cols[b]) continue;
+        orColumn(fb, x + cx, dy, cols[b]);
+      }
+    }
+  }
+}
+
+void Raster1bpp::blitColumns(uint8_t* fb, int16_t x, int16_t y,
+                             const uint8_t* cols, int16_t w, uint8_t pages) {
+  if (x >= kWidth || y >= kHeight || x + w <= 0 || y + pages * 8 <= 0) return;
+  int16_t c0 = x < 0 ? -x : 0;
+  int16_t c1 = x + w > kWidth ? kWidth - x : w;
+
+  for (uint8_t p = 0; p < pages; ++p) {
+    int16_t dy = y + p * 8;
+    if (dy + 8 <= 0 || dy >= kHeight) continue;
+    const uint8_t* src = cols + p * w;
+    for (int16_t c = c0; c < c1; ++c) {
+      if (src[c]) orColumn(fb, x + c, dy, src[c]);
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Drawing kernels that write straight into an SSD1306 page-major
+// framebuffer: 8 pages of 128 bytes, each byte a column of 8 pixels with
+// the LSB on top. All calls clip to the 128x64 panel and only set pixels,
+// except clearRect().
+class Raster1bpp {
+public:
+  static const int16_t kWidth = 128;
+  static const int16_t kHeight = 64;
+
+  static void fillRect(uint8_t* fb, int16_t x, int16_t y, int16_t w, int16_t h);
+  static void drawRect(uint8_t* fb, int16_t x, int16_t y, int16_t w, int16_t h);
+  static void clearRect(uint8_t* fb, int16_t x, int16_t y, int16_t w, int16_t h);
+  // Adafruit_GFX bitmap layout: row-major, MSB = leftmost pixel, rows
+  // padded to whole bytes.
+  static void drawBitmap(uint8_t* fb, int16_t x, int16_t y,
+                         const uint8_t* bitmap, int16_t w, int16_t h);
+  // Page-major source (`pages` rows of w column bytes) drawn with its top
+  // row at y.
+  static void blitColumns(uint8_t* fb, int16_t x, int16_t y,
+                          const uint8_t* cols, int16_t w, uint8_t pages);
+
+private:
+  static void orSpan(uint8_t* row, int16_t x0, int16_t x1, uint8_t mask);
+  static void orColumn(uint8_t* fb, int16_t x, int16_t y, uint8_t bits);
+};
@@ -0,0 +1,101 @@
+#include "Resampler.h"
+#include <math.h>
+
+// 48 kHz design grid: 7 kHz cutoff keeps the 16 kHz side alias-free past
+// ~8 kHz with ~55 dB of stopband (Kaiser beta 5).
+static const float kCutoffHz = 7000.0f;
+static const float kDesignRateHz = 48000.0f;
+static const float kKaiserBeta = 5.0f;
+
+static float besselI0(float x) {
+  float sum = 1.0f;
+  float term = 1.0f;
+  for (int k = 1; k < 20; ++k) {
+    term *= (x / (2.0f * k)) * (x / (2.0f * k));
+    sum += term;
+  }
+  return sum;
+}
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > 32767) return 32767;
+  if (v < -32768) return -32768;
+  return (int16_t)v;
+}
+
+void Resampler::begin(Ratio ratio) {
+  if (ratio == DOWN_3_2) {
+    up = 2;
+    down = 3;
+  } else {
+    up = 3;
+    down = 2;
+  }
+  design();
+  reset();
+}
+
+void Resampler::reset() {
+  memset(work, 0, sizeof(work));
+  t = kHistory * up;
+}
+
+// One-time float work at begin(); the prototype carries gain `up` so each
+// phase sums to ~1.0 and sum(|taps|) per phase stays well under 2, which
+// keeps the int32 accumulator from overflowing.
+void Resampler::design() {
+  const int taps = kTapsPerPhase * up;
+  const float center = (taps - 1) * 0.5f;
+  const float fc = kCutoffHz / kDesignRateHz;
+  const float i0Beta = besselI0(kKaiserBeta);
+
+  float proto[kTapsPerPhase * kMaxPhases];
+  float sum = 0.0f;
+  for (int n = 0; n < taps; ++n) {
+    float x = n - center;
+    float sinc = (x == 0.0f) ? 2.0f * fc
+                             : sinf(2.0f * (float)M_PI * fc * x) / ((float)M_PI * x);
+    float r = x / center;
+    float w = besselI0(kKaiserBeta * sqrtf(1.0f - r * r)) / i0Beta;
+    proto[n] = sinc * w;
+    sum += proto[n];
+  }
+
+  for (int p = 0; p < up; ++p) {
+    for (int j = 0; j < kTapsPerPhase; ++j) {
+      float h = proto[p + j * up] * (float)up / sum;
+      coeffs[p][j] = (int16_t)lrintf(h * 32767.0f);
+    }
+  }
+}
+
+int Resampler::process(const int16_t* in, int n, int16_t* out) {
+  int produced = 0;
+  while (n > 0) {
+    int chunk = n < kBlock ? n : kBlock;
+    produced += processBlock(in, chunk, out + produced);
+    in += chunk;
+    n -= chunk;
+  }
+  return produced;
+}
+
+int Resampler::processBlock(const int16_t* in, int n, int16_t* out) {
+  memcpy(work + kHistory, in, n * sizeof(int16_t));
+  const int len = kHistory + n;
+
+  int produced = 0;
+  while (t / up < len) {
+    const int i = t / up;
+    const int16_t* c = coeffs[t % up];
+    const int16_t* x = work + i;
+    int32_t acc = 1 << 14;
+    for (int j = 0; j < kTapsPerPhase; ++j) acc += (int32_t)c[j] * x[-j];
+    out[produced++] = saturate16(acc >> 15);
+    t += down;
+  }
+
+  memmove(work, work + n, kHistory * sizeof(int16_t));
+  t -= n * up;
+  return produced;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Fixed-point polyphase resampler for the two rational steps between the
+// 24 kHz I2S rate and 16 kHz sessions. Both run a Kaiser-windowed sinc
+// designed at the common 48 kHz upsampled rate, split into L phases of
+// kTapsPerPhase Q15 taps, so each output costs kTapsPerPhase MACs.
+class Resampler {
+public:
+  enum Ratio {
+    DOWN_3_2 = 0,   // 24 kHz -> 16 kHz (L = 2, M = 3)
+    UP_2_3          // 16 kHz -> 24 kHz (L = 3, M = 2)
+  };
+
+  void begin(Ratio ratio);
+  void reset();
+
+  // Streams `n` input samples through the filter and returns the number of
+  // outputs written, at most maxOutput(n). Any `n` is accepted; long inputs
+  // are processed in kBlock pieces.
+  int process(const int16_t* in, int n, int16_t* out);
+  int maxOutput(int n) const { return (n * up) / down + 1; }
+
+private:
+  static const int kTapsPerPhase = 32;
+  static const int kMaxPhases = 3;
+  static const int kBlock = 256;
+  static const int kHistory = kTapsPerPhase - 1;
+
+  void design();
+  int processBlock(const int16_t* in, int n, int16_t* out);
+
+  int up = 1;
+  int down = 1;
+  // coeffs[p][j] = h[p + j * up]: tap j of phase p, applied to x[i - j].
+  int16_t coeffs[kMaxPhases][kTapsPerPhase];
+  int16_t work[kHistory + kBlock];
+  // Position of the next output on the upsampled grid, relative to work[0].
+  int32_t t = 0;
+};
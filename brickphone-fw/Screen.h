@@ -12,5 +12,14 @@ public:
   virtual void onExit() {}
   virtual void tick(unsigned long dtMs) { (void)dtMs; }
   virtual void handleInput(InputService&) {}
-  virtual void render(DisplayService&) = 0;
+  // Fixed-timestep simulation: while fixedStepMs() is non-zero, ScreenManager
+  // calls fixedUpdate() once per elapsed step, independent of frame and
+  // loop timing. render() gets `alpha`, how far (0..1) the frame sits
+  // between the last step and the next, for interpolating motion.
+  virtual unsigned long fixedStepMs() const { return 0; }
+  virtual void fixedUpdate() {}
+  // False while the screen only changes in response to input; the idle
+  // governor (PowerService) then stops redrawing it at full rate.
+  virtual bool wantsAnimation() const { return true; }
+  virtual void render(DisplayService& display, float alpha) = 0;
 };
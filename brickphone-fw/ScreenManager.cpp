@@ -1,6 +1,7 @@
 #include "ScreenManager.h"
 #include "DisplayService.h"
 #include "AudioOutService.h"
+#include "Profiler.h"
 
 void ScreenManager::registerScreen(ScreenId id, Screen* screen) {
   screens[(int)id] = screen;
@@ -14,22 +15,49 @@ void ScreenManager::set(ScreenId id) {
   if (currentScreen) currentScreen->onExit();
   current = id;
   currentScreen = screens[(int)id];
+  stepAccumMs = 0;
   if (currentScreen) currentScreen->onEnter();
 }
 
 void ScreenManager::tick(unsigned long dtMs, InputService& input) {
   if (!currentScreen) return;
 
-  if (input.pressed(BTN_START) && current != ScreenId::Menu) {
+  // SELECT+START cycles the profiler instead of leaving the screen. The
+  // screen doesn't see that input, but its time still runs.
+  if (input.pressed(BTN_START) && input.down(BTN_SELECT)) {
+    if (profiler) profiler->cycleMode();
+  } else if (input.pressed(BTN_START) && current != ScreenId::Menu) {
     if (audioOut) audioOut->playSfx(SFX_CLICK);
     set(ScreenId::Menu);
     return;
+  } else {
+    ProfScope scope(profiler, STAGE_HANDLE_INPUT);
+    currentScreen->handleInput(input);
   }
 
-  currentScreen->handleInput(input);
+  unsigned long stepMs = currentScreen->fixedStepMs();
+  if (stepMs > 0) {
+    stepAccumMs += dtMs;
+    int steps = 0;
+    while (stepAccumMs >= stepMs && steps < kMaxCatchUpSteps) {
+      ProfScope scope(profiler, STAGE_FIXED_UPDATE);
+      currentScreen->fixedUpdate();
+      stepAccumMs -= stepMs;
+      steps++;
+    }
+    if (stepAccumMs >= stepMs) stepAccumMs %= stepMs;
+  }
+
+  ProfScope scope(profiler, STAGE_SCREEN_TICK);
   currentScreen->tick(dtMs);
 }
 
 void ScreenManager::render(DisplayService& display) {
-  if (currentScreen) currentScreen->render(display);
+  if (!currentScreen) return;
+  unsigned long stepMs = currentScreen->fixedStepMs();
+  float alpha = 0.0f;
+  // The step may have shrunk since the last tick (e.g. Snake's fast mode).
+  if (stepMs > 0 && stepAccumMs < stepMs) alpha = (float)stepAccumMs / (float)stepMs;
+  ProfScope scope(profiler, STAGE_RENDER);
+  currentScreen->render(display, alpha);
 }
@@ -4,6 +4,7 @@
 #include "InputService.h"
 
 class AudioOutService;
+class Profiler;
 
 enum class ScreenId {
   Splash = 0,
@@ -23,14 +24,22 @@ class ScreenManager {
 public:
   void registerScreen(ScreenId id, Screen* screen);
   void setAudio(AudioOutService* audio);
+  void setProfiler(Profiler* prof) { profiler = prof; }
   void set(ScreenId id);
   void tick(unsigned long dtMs, InputService& input);
   void render(DisplayService& display);
   ScreenId currentId() const { return current; }
+  bool wantsAnimation() const { return currentScreen && currentScreen->wantsAnimation(); }
 
 private:
+  // Steps run per tick at most; a longer stall drops the backlog instead of
+  // fast-forwarding through it.
+  static const int kMaxCatchUpSteps = 4;
+
   Screen* screens[11] = {};
   ScreenId current = ScreenId::Splash;
   Screen* currentScreen = nullptr;
   AudioOutService* audioOut = nullptr;
+  Profiler* profiler = nullptr;
+  unsigned long stepAccumMs = 0;
 };
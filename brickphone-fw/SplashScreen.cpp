@@ -25,7 +25,7 @@ void SplashScreen::tick(unsigned long) {
   }
 }
 
-void SplashScreen::render(DisplayService& display) {
+void SplashScreen::render(DisplayService& display, float) {
   display.drawCentered("BRICKPHONE", 18, 2);
   unsigned long t = millis() / 200;
   int16_t x = 40 + (t % 5) * 6;
@@ -10,7 +10,7 @@ public:
   void onEnter() override;
   void handleInput(InputService& input) override;
   void tick(unsigned long dtMs) override;
-  void render(DisplayService& display) override;
+  void render(DisplayService& display, float alpha) override;
 
 private:
   AudioOutService& audioOut;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring over caller-owned storage.
+// Capacity must be a power of two; head/tail run free and wrap naturally,
+// so a full ring needs no spare slot. Bulk push/pop copy in at most two
+// memcpy segments.
+template <typename T>
+class SpscRing {
+public:
+  void init(T* storage, uint32_t capacity) {
+    buf = storage;
+    cap = capacity;
+    mask = capacity - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    clearMark.store(0, std::memory_order_relaxed);
+    clearSeq.store(0, std::memory_order_relaxed);
+    seenClearSeq = 0;
+  }
+
+  uint32_t capacity() const { return cap; }
+
+  // Snapshot from either side; may still include items a pending clear()
+  // will discard.
+  uint32_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+  uint32_t space() const { return cap - size(); }
+
+  // Producer side.
+  uint32_t push(const T* src, uint32_t count) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t freeSlots = cap - (h - tail.load(std::memory_order_acquire));
+    if (count > freeSlots) count = freeSlots;
+    if (count == 0) return 0;
+
+    uint32_t at = h & mask;
+    uint32_t first = (count < cap - at) ? count : cap - at;
+    memcpy(buf + at, src, first * sizeof(T));
+    if (count > first) memcpy(buf, src + first, (count - first) * sizeof(T));
+    head.store(h + count, std::memory_order_release);
+    return count;
+  }
+
+  // Producer side: the consumer skips everything pushed before this call.
+  void clear() {
+    clearMark.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    clearSeq.fetch_add(1, std::memory_order_release);
+  }
+
+  // Consumer side.
+  uint32_t pop(T* dst, uint32_t count) {
+    uint32_t t = applyClear();
+    uint32_t avail = head.load(std::memory_order_acquire) - t;
+    if (count > avail) count = avail;
+    if (count == 0) return 0;
+
+    uint32_t at = t & mask;
+    uint32_t first = (count < cap - at) ? count : cap - at;
+    memcpy(dst, buf + at, first * sizeof(T));
+    if (count > first) memcpy(dst + first, buf, (count - first) * sizeof(T));
+    tail.store(t + count, std::memory_order_release);
+    return count;
+  }
+
+  // Consumer side: drop everything currently queued.
+  void discard() {
+    applyClear();
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+private:
+  uint32_t applyClear() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t seq = clearSeq.load(std::memory_order_acquire);
+    if (seq != seenClearSeq) {
+      seenClearSeq = seq;
+      uint32_t markAt = clearMark.load(std::memory_order_relaxed);
+      // Only ever move forward: the mark may predate items already popped.
+      if ((int32_t)(markAt - t) > 0) {
+        t = markAt;
+        tail.store(t, std::memory_order_release);
+      }
+    }
+    return t;
+  }
+
+  T* buf = nullptr;
+  uint32_t cap = 0;
+  uint32_t mask = 0;
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  std::atomic<uint32_t> clearMark{0};
+  std::atomic<uint32_t> clearSeq{0};
+  uint32_t seenClearSeq = 0;
+};
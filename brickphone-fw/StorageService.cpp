@@ -1,4 +1,145 @@
 #include "StorageService.h"
+#include <LittleFS.h>
 
-void StorageService::begin() {
+bool StorageService::begin() {
+  if (mounted) return true;
+  // Formats on first boot, when the partition holds no filesystem yet.
+  mounted = LittleFS.begin(true);
+  if (!mounted) return false;
+  xTaskCreatePinnedToCore(writerTaskThunk, "fsWriter", 4096, this, 1, &writerTask, 0);
+  return true;
+}
+
+size_t StorageService::totalBytes() const {
+  return mounted ? LittleFS.totalBytes() : 0;
+}
+
+size_t StorageService::usedBytes() const {
+  return mounted ? LittleFS.usedBytes() : 0;
+}
+
+bool StorageService::exists(const char* path) const {
+  return mounted && LittleFS.exists(path);
+}
+
+bool StorageService::remove(const char* path) {
+  return mounted && LittleFS.remove(path);
+}
+
+bool StorageService::makeDir(const char* path) {
+  if (!mounted) return false;
+  return LittleFS.exists(path) || LittleFS.mkdir(path);
+}
+
+void StorageService::listDir(const char* dir, FileVisitor fn, void* ctx) {
+  if (!mounted) return;
+  File root = LittleFS.open(dir, FILE_READ);
+  if (!root || !root.isDirectory()) return;
+  for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+    if (!f.isDirectory()) fn(f.name(), f.size(), ctx);
+    f.close();
+  }
+  root.close();
+}
+
+bool StorageService::openWriter(const char* path) {
+  if (!mounted || writing) return false;
+  writer = LittleFS.open(path, FILE_WRITE);
+  if (!writer) return false;
+  writing = true;
+  writeFailed = false;
+  fillBlock = 0;
+  fillLen = 0;
+  pendingBlock = -1;
+  return true;
+}
+
+size_t StorageService::writeSpace() const {
+  if (!writing) return 0;
+  size_t space = kBlockSize - fillLen;
+  if (pendingBlock < 0) space += kBlockSize;
+  return space;
+}
+
+size_t StorageService::write(const void* data, size_t len) {
+  if (!writing) return 0;
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  size_t taken = 0;
+  while (taken < len) {
+    if (fillLen == kBlockSize) {
+      if (pendingBlock >= 0) break;   // both blocks busy: caller retries later
+      pendingBlock = fillBlock;
+      xTaskNotifyGive(writerTask);
+      fillBlock ^= 1;
+      fillLen = 0;
+    }
+    size_t n = kBlockSize - fillLen;
+    if (n > len - taken) n = len - taken;
+    memcpy(blocks[fillBlock] + fillLen, src + taken, n);
+    fillLen += n;
+    taken += n;
+  }
+  return taken;
+}
+
+void StorageService::waitForWriter() {
+  while (pendingBlock >= 0) vTaskDelay(1);
+}
+
+bool StorageService::closeWriter(const void* header, size_t headerLen) {
+  if (!writing) return false;
+  waitForWriter();
+  if (fillLen > 0 && writer.write(blocks[fillBlock], fillLen) != fillLen) {
+    writeFailed = true;
+  }
+  if (header && headerLen > 0) {
+    writer.seek(0);
+    if (writer.write(static_cast<const uint8_t*>(header), headerLen) != headerLen) {
+      writeFailed = true;
+    }
+  }
+  writer.close();
+  writing = false;
+  fillLen = 0;
+  return !writeFailed;
+}
+
+bool StorageService::openReader(const char* path, size_t offset) {
+  if (!mounted) return false;
+  if (reader) reader.close();
+  reader = LittleFS.open(path, FILE_READ);
+  if (!reader) return false;
+  if (offset > 0 && !reader.seek(offset)) {
+    reader.close();
+    return false;
+  }
+  return true;
+}
+
+size_t StorageService::read(void* dst, size_t len) {
+  if (!reader) return 0;
+  return reader.read(static_cast<uint8_t*>(dst), len);
+}
+
+void StorageService::closeReader() {
+  if (reader) reader.close();
+}
+
+void StorageService::writerTaskThunk(void* arg) {
+  auto* self = reinterpret_cast<StorageService*>(arg);
+  self->writerTaskLoop();
+}
+
+// Doing the writes here keeps LittleFS's own work and the block hand-off
+// off the UI loop. It does not shield the other tasks: while a sector is
+// erased or programmed, every task on both cores that runs from flash or
+// touches PSRAM stalls (see kFlashStallMs).
+void StorageService::writerTaskLoop() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int idx = pendingBlock;
+    if (idx < 0) continue;
+    if (writer.write(blocks[idx], kBlockSize) != kBlockSize) writeFailed = true;
+    pendingBlock = -1;
+  }
 }
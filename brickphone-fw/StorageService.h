@@ -1,6 +1,67 @@
 #pragma once
 
+#include <Arduino.h>
+#include <FS.h>
+
+// LittleFS on the "spiffs" data partition (see partitions.csv) plus one
+// streaming writer. write() fills a 4 KB block in RAM; full blocks go to a
+// background task that writes them at 4 KB-aligned file offsets while the
+// caller fills the other block, so the UI loop never waits on flash.
 class StorageService {
 public:
-  void begin();
+  static const size_t kBlockSize = 4096;
+  // Flash erases and writes turn off the cache on both cores, which also
+  // cuts off PSRAM, until the operation ends. A 4 KB sector erase is the
+  // longest one the writer causes: ~45 ms typically, and this allows for
+  // slow sectors. Real-time paths ride it out on DMA buffers in internal
+  // RAM, which keep running.
+  static const uint32_t kFlashStallMs = 150;
+
+  bool begin();
+  bool isMounted() const { return mounted; }
+  size_t totalBytes() const;
+  size_t usedBytes() const;
+  bool exists(const char* path) const;
+  bool remove(const char* path);
+  bool makeDir(const char* path);
+  // Calls `fn` for every regular file directly inside `dir`.
+  typedef void (*FileVisitor)(const char* name, size_t size, void* ctx);
+  void listDir(const char* dir, FileVisitor fn, void* ctx);
+
+  // Streaming writer (one at a time).
+  bool openWriter(const char* path);
+  // Bytes write() can take right now without a block still in flight.
+  size_t writeSpace() const;
+  // Copies up to `len` bytes; returns how many were taken.
+  size_t write(const void* data, size_t len);
+  // Flushes the tail, optionally rewrites the first `headerLen` bytes
+  // (e.g. a WAV header whose sizes are only known now), and closes.
+  bool closeWriter(const void* header = nullptr, size_t headerLen = 0);
+  bool writerOpen() const { return writing; }
+  // Set when a background block write came up short (usually a full disk).
+  bool writerFailed() const { return writeFailed; }
+
+  // Plain synchronous reader (one at a time); reads are cheap on LittleFS.
+  bool openReader(const char* path, size_t offset = 0);
+  size_t read(void* dst, size_t len);
+  void closeReader();
+
+private:
+  static void writerTaskThunk(void* arg);
+  void writerTaskLoop();
+  void waitForWriter();
+
+  bool mounted = false;
+
+  File writer;
+  File reader;
+  bool writing = false;
+  volatile bool writeFailed = false;
+
+  alignas(4) uint8_t blocks[2][kBlockSize];
+  int fillBlock = 0;
+  size_t fillLen = 0;
+  // Block index handed to the writer task, or -1 while it is idle.
+  volatile int pendingBlock = -1;
+  TaskHandle_t writerTask = nullptr;
 };
@@ -0,0 +1,127 @@
+#include "TextCache.h"
+#include "Raster1bpp.h"
+#include <Adafruit_GFX.h>
+
+static uint32_t hashText(const char* text, uint8_t size) {
+  uint32_t h = 2166136261u ^ size;
+  for (const char* p = text; *p; ++p) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Doubles each bit of a glyph column into the low/high page of a size-2 glyph.
+static uint16_t stretchBits(uint8_t bits) {
+  uint16_t out = 0;
+  for (uint8_t b = 0; b < 8; ++b) {
+    if (bits & (1 << b)) out |= (uint16_t)(3u << (2 * b));
+  }
+  return out;
+}
+
+void TextCache::begin() {
+  // Render each glyph once through GFX so the atlas matches print() exactly.
+  GFXcanvas1 canvas(6, 8);
+  for (int i = 0; i < kGlyphCount; ++i) {
+    canvas.fillScreen(0);
+    canvas.drawChar(0, 0, (unsigned char)(kFirstChar + i), 1, 1, 1);
+    for (int16_t cx = 0; cx < 5; ++cx) {
+      uint8_t col = 0;
+      for (int16_t cy = 0; cy < 8; ++cy) {
+        if (canvas.getPixel(cx, cy)) col |= (uint8_t)(1 << cy);
+      }
+      glyphs1[i][cx] = col;
+      uint16_t tall = stretchBits(col);
+      for (uint8_t p = 0; p < 2; ++p) {
+        uint8_t half = (uint8_t)(tall >> (8 * p));
+        glyphs2[i][p][2 * cx] = half;
+        glyphs2[i][p][2 * cx + 1] = half;
+      }
+    }
+  }
+  ready = true;
+}
+
+bool TextCache::supported(const char* text, uint8_t size, int* lenOut) {
+  if (!text || (size != 1 && size != 2)) return false;
+  int len = 0;
+  for (const char* p = text; *p; ++p, ++len) {
+    if (*p == '\n' || *p == '\r') continue;
+    if (*p < kFirstChar || *p > kLastChar) return false;
+  }
+  if (lenOut) *lenOut = len;
+  return true;
+}
+
+const uint8_t* TextCache::glyph(char c, uint8_t size) const {
+  int i = c - kFirstChar;
+  return size == 1 ? glyphs1[i] : &glyphs2[i][0][0];
+}
+
+bool TextCache::drawText(uint8_t* fb, int16_t x, int16_t y, const char* text, uint8_t size) {
+  if (!ready || !supported(text, size, nullptr)) return false;
+
+  const int16_t advance = 6 * size;
+  const int16_t lineH = 8 * size;
+  const int16_t glyphW = 5 * size;
+  for (const char* p = text; *p; ++p) {
+    if (*p == '\n') {
+      x = 0;
+      y += lineH;
+      continue;
+    }
+    if (*p == '\r') continue;
+    if (x + advance > Raster1bpp::kWidth) {
+      x = 0;
+      y += lineH;
+    }
+    Raster1bpp::blitColumns(fb, x, y, glyph(*p, size), glyphW, size);
+    x += advance;
+  }
+  return true;
+}
+
+const TextCache::Strip* TextCache::strip(const char* text, uint8_t size) {
+  int len = 0;
+  if (!ready || !supported(text, size, &len)) return nullptr;
+  if (len == 0 || len * 6 * size > Raster1bpp::kWidth || strpbrk(text, "\r\n")) return nullptr;
+
+  uint32_t hash = hashText(text, size);
+  useClock++;
+
+  Entry* victim = &entries[0];
+  for (int i = 0; i < kEntries; ++i) {
+    Entry& e = entries[i];
+    if (e.strip.cols && e.hash == hash && e.size == size && strcmp(e.text, text) == 0) {
+      e.lastUse = useClock;
+      return &e.strip;
+    }
+    if (!e.strip.cols || e.lastUse < victim->lastUse) victim = &e;
+    if (!victim->strip.cols) break;
+  }
+
+  victim->hash = hash;
+  victim->lastUse = useClock;
+  victim->size = size;
+  memcpy(victim->text, text, len + 1);
+  rasterize(*victim, text, len, size);
+  return &victim->strip;
+}
+
+void TextCache::rasterize(Entry& entry, const char* text, int len, uint8_t size) {
+  const int16_t advance = 6 * size;
+  const int16_t glyphW = 5 * size;
+  const int16_t width = len * advance;
+
+  memset(entry.cols, 0, sizeof(entry.cols));
+  for (int i = 0; i < len; ++i) {
+    const uint8_t* g = glyph(text[i], size);
+    for (uint8_t p = 0; p < size; ++p) {
+      memcpy(entry.cols + p * width + i * advance, g + p * glyphW, glyphW);
+    }
+  }
+  entry.strip.width = width;
+  entry.strip.pages = size;
+  entry.strip.cols = entry.cols;
+}
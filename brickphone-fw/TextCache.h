@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Page-aligned copies of the Adafruit_GFX 5x7 font at sizes 1 and 2, plus
+// a small cache of pre-rasterized single-line strings for labels that are
+// redrawn every frame ("GAME OVER", menu entries, ...).
+class TextCache {
+public:
+  struct Strip {
+    int16_t width;
+    uint8_t pages;
+    const uint8_t* cols;
+  };
+
+  void begin();
+
+  // Draws printable ASCII at size 1 or 2 with Adafruit_GFX wrap/newline
+  // rules. Returns false if the text needs the generic GFX path.
+  bool drawText(uint8_t* fb, int16_t x, int16_t y, const char* text, uint8_t size);
+
+  // Cached strip for a line that fits on one row; nullptr if the text
+  // can't be cached.
+  const Strip* strip(const char* text, uint8_t size);
+
+private:
+  static const char kFirstChar = ' ';
+  static const char kLastChar = '~';
+  static const int kGlyphCount = kLastChar - kFirstChar + 1;
+  static const int kMaxChars = 128 / 6;
+  static const int kEntries = 12;
+
+  struct Entry {
+    uint32_t hash;
+    uint32_t lastUse;
+    uint8_t size;
+    char text[kMaxChars + 1];
+    Strip strip;
+    uint8_t cols[128 * 2];
+  };
+
+  static bool supported(const char* text, uint8_t size, int* lenOut);
+  const uint8_t* glyph(char c, uint8_t size) const;
+  void rasterize(Entry& entry, const char* text, int len, uint8_t size);
+
+  bool ready = false;
+  uint8_t glyphs1[kGlyphCount][5];
+  uint8_t glyphs2[kGlyphCount][2][10];
+  Entry entries[kEntries] = {};
+  uint32_t useClock = 0;
+};
@@ -1,11 +1,15 @@
 #include <Arduino.h>
 #include "Pins.h"
 #include "InputService.h"
+#include "InputRecorder.h"
 #include "DisplayService.h"
 #include "AudioOutService.h"
 #include "MicInService.h"
 #include "NetService.h"
 #include "StorageService.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "PowerService.h"
 #include "ScreenManager.h"
 #include "SplashScreen.h"
 #include "MenuScreen.h"
@@ -20,18 +24,22 @@
 #include "AppFlappy.h"
 
 InputService input;
+InputRecorder recorder;
 DisplayService display;
 AudioOutService audioOut;
 MicInService micIn;
 NetService net;
 StorageService storage;
+AssetPack assets;
+Profiler profiler;
 
 ScreenManager screens;
+PowerService power(screens, input, display, audioOut, micIn, storage, net, profiler);
 
 SplashScreen splashScreen(audioOut, screens);
 MenuScreen menuScreen(screens, audioOut);
 AppSnake appSnake(audioOut);
-AppRecorder appRecorder(micIn, audioOut);
+AppRecorder appRecorder(micIn, audioOut, storage);
 AppVoice appVoice(micIn, audioOut);
 AppSettings appSettings(audioOut, net, screens);
 AppPong appPong(audioOut);
@@ -41,18 +49,25 @@ App2048 app2048(audioOut);
 AppFlappy appFlappy(audioOut);
 
 unsigned long lastTickMs = 0;
-unsigned long lastDisplayMs = 0;
-static const unsigned long kFrameMs = 33;
 
 void setup() {
   Serial.begin(115200);
   delay(200);
+  // One seed per boot, so a recorded session replays with the same food,
+  // tiles and pipes. randomSeed(0) would leave random() on the hardware RNG.
+  uint32_t seed = esp_random();
+  if (seed == 0) seed = 1;
+  randomSeed(seed);
+  assets.begin();
+  display.setAssets(&assets);
+  audioOut.setAssets(&assets);
   input.begin();
   display.begin();
   audioOut.begin();
   micIn.begin();
   net.begin();
   storage.begin();
+  profiler.begin();
 
   screens.registerScreen(ScreenId::Splash, &splashScreen);
   screens.registerScreen(ScreenId::Menu, &menuScreen);
@@ -66,27 +81,43 @@ void setup() {
   screens.registerScreen(ScreenId::Game2048, &app2048);
   screens.registerScreen(ScreenId::Flappy, &appFlappy);
   screens.setAudio(&audioOut);
+  screens.setProfiler(&profiler);
 
   screens.set(ScreenId::Splash);
+  power.begin();
   lastTickMs = millis();
+  recorder.begin(seed, lastTickMs);
 }
 
 void loop() {
+  ProfScope loopScope(&profiler, STAGE_LOOP);
   unsigned long now = millis();
   unsigned long dt = now - lastTickMs;
   lastTickMs = now;
 
-  input.poll(now);
-  net.tick(now);
-  micIn.tick(now);
-  audioOut.tick(now);
+  {
+    ProfScope scope(&profiler, STAGE_INPUT);
+    input.poll(now);
+    recorder.capture(input);
+  }
+  {
+    ProfScope scope(&profiler, STAGE_SERVICES);
+    net.tick(now);
+    micIn.tick(now);
+    audioOut.tick(now);
+  }
 
   screens.tick(dt, input);
+  power.update(now);
 
-  if (now - lastDisplayMs >= kFrameMs) {
-    lastDisplayMs = now;
+  if (power.frameDue(now)) {
     display.beginFrame();
     screens.render(display);
-    display.endFrame();
+    profiler.drawOverlay(display);
+    ProfScope scope(&profiler, STAGE_END_FRAME);
+    power.frameDone(now, display.endFrame());
   }
+
+  profiler.tick(now);
+  power.rest(now);
 }
@@ -0,0 +1,56 @@
+#pragma once
+#include <Arduino.h>
+
+// Minimal Adafruit_GFX: pixel, rect, bitmap and classic 6x8 text drawing.
+// The built-in font is a 5x7 ASCII set of the same geometry as glcdfont.c;
+// glyph shapes may differ slightly from the real library.
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {}
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  virtual void fillScreen(uint16_t color) { fillRect(0, 0, WIDTH, HEIGHT, color); }
+  void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h,
+                  uint16_t color);
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                uint8_t size);
+
+  void setTextSize(uint8_t s) { textSize = s ? s : 1; }
+  void setTextColor(uint16_t c) { textColor = c; }
+  void setTextWrap(bool w) { wrap = w; }
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  void getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1,
+                     uint16_t* w, uint16_t* h);
+
+  size_t write(uint8_t c) override;
+  using Print::print;
+
+  int16_t width() const { return WIDTH; }
+  int16_t height() const { return HEIGHT; }
+
+protected:
+  const int16_t WIDTH;
+  const int16_t HEIGHT;
+  int16_t cursorX = 0;
+  int16_t cursorY = 0;
+  uint8_t textSize = 1;
+  uint16_t textColor = 1;
+  bool wrap = true;
+};
+
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+  GFXcanvas1(uint16_t w, uint16_t h);
+  ~GFXcanvas1();
+  GFXcanvas1(const GFXcanvas1&) = delete;
+  GFXcanvas1& operator=(const GFXcanvas1&) = delete;
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+  bool getPixel(int16_t x, int16_t y) const;
+  uint8_t* getBuffer() const { return buffer; }
+
+private:
+  uint8_t* buffer;
+};
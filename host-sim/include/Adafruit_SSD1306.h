@@ -0,0 +1,37 @@
+#pragma once
+#include "Adafruit_GFX.h"
+#include <Wire.h>
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+
+// Page-major 1bpp buffer like the real driver. begin() only probes the
+// address and display() pushes the whole buffer; the init sequence is not
+// replayed because the simulated controller powers up ready to draw.
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  // The buffer is never freed: subclasses may swap in their own (see
+  // DisplayService::Panel), and the display lives as long as the program.
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst = -1);
+  Adafruit_SSD1306(const Adafruit_SSD1306&) = delete;
+  Adafruit_SSD1306& operator=(const Adafruit_SSD1306&) = delete;
+
+  bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0x3C,
+             bool reset = true, bool periphBegin = true);
+  void display();
+  void clearDisplay();
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void ssd1306_command(uint8_t c);
+  uint8_t* getBuffer() { return buffer; }
+
+protected:
+  uint8_t* buffer = nullptr;
+
+private:
+  TwoWire* wire;
+  uint8_t i2caddr = 0;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+// Host stand-in for the Arduino-ESP32 core: just the API the firmware uses.
+// Time is the sim clock; random() is a seeded PRNG so runs repeat exactly.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "freertos/FreeRTOS.h"
+
+#define PROGMEM
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+// Edge handlers run synchronously on the pin change, from whichever context
+// changed it (normally the harness via sim::setPinLevel).
+void attachInterrupt(uint8_t pin, void (*fn)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*fn)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(p) (((p) < 64) ? (p) : -1)
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+class String {
+public:
+  String(const char* s = "") : str(s ? s : "") {}
+  String(const char* s, size_t n) : str(s, n) {}
+  String(const std::string& s) : str(s) {}
+  String(int v) : str(std::to_string(v)) {}
+  String(unsigned int v) : str(std::to_string(v)) {}
+  String(long v) : str(std::to_string(v)) {}
+  String(unsigned long v) : str(std::to_string(v)) {}
+  String(float v, unsigned int decimals = 2);
+
+  String operator+(const String& o) const { return String(str + o.str); }
+  String operator+(const char* o) const { return String(str + (o ? o : "")); }
+  String& operator+=(const String& o) { str += o.str; return *this; }
+  bool operator==(const String& o) const { return str == o.str; }
+  bool operator==(const char* o) const { return str == (o ? o : ""); }
+
+  int indexOf(const char* s, unsigned int from = 0) const { return find(str.find(s, from)); }
+  int indexOf(char c, unsigned int from = 0) const { return find(str.find(c, from)); }
+  String substring(unsigned int from) const { return substring(from, length()); }
+  String substring(unsigned int from, unsigned int to) const;
+  long toInt() const { return strtol(str.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(str.c_str(), nullptr); }
+  bool startsWith(const char* s) const { return str.rfind(s, 0) == 0; }
+  unsigned int length() const { return (unsigned int)str.size(); }
+  const char* c_str() const { return str.c_str(); }
+
+private:
+  static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  std::string str;
+};
+
+inline String operator+(const char* a, const String& b) { return String(a) + b; }
+
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) write(data[i]);
+    return len;
+  }
+  size_t print(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// USB CDC. Output goes to the sink set with sim::setSerialSink(), else it
+// is dropped.
+class HWCDC : public Print {
+public:
+  void begin(unsigned long) {}
+  int available() { return 0; }
+  int read() { return -1; }
+  int availableForWrite() { return 4096; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t len) override;
+  using Print::print;
+  using Print::println;
+};
+extern HWCDC Serial;
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+  uint8_t operator[](int i) const { return octets[i]; }
+
+private:
+  uint8_t octets[4];
+};
+
+// getCycleCount() follows the host's monotonic clock scaled to 240 MHz, so
+// the profiler measures real host cost even though sim time stands still
+// inside a loop() pass.
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getFreeHeap();
+};
+extern EspClass ESP;
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+struct FileImpl;
+
+// Handle semantics like the Arduino core: copies share one open file.
+class File {
+public:
+  File() = default;
+  explicit File(std::shared_ptr<FileImpl> impl) : impl(std::move(impl)) {}
+
+  size_t write(const uint8_t* data, size_t len);
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t read(uint8_t* dst, size_t len);
+  int available();
+  bool seek(uint32_t pos);
+  size_t position() const;
+  size_t size() const;
+  void flush();
+  void close();
+  const char* name() const;
+  const char* path() const;
+  bool isDirectory();
+  File openNextFile();
+  explicit operator bool() const;
+
+private:
+  std::shared_ptr<FileImpl> impl;
+};
+
+// Maps the flash filesystem onto a host directory.
+class FS {
+public:
+  File open(const char* path, const char* mode = FILE_READ);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+  bool rmdir(const char* path);
+
+protected:
+  std::string hostPath(const char* path) const;
+  std::string root;
+};
+
+}  // namespace fs
+
+using fs::File;
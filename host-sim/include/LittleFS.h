@@ -0,0 +1,14 @@
+#pragma once
+#include "FS.h"
+
+// The host directory comes from sim::setFsRoot(); sizes mimic the spiffs
+// partition in partitions.csv.
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char* label = "spiffs");
+  void end() {}
+  size_t totalBytes();
+  size_t usedBytes();
+};
+extern LittleFSFS LittleFS;
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Harness-side control of the simulated board. The firmware never includes
+// this; sim_main (and later tools) drive it.
+//
+// Time only moves when the harness calls advanceUs() or when the main
+// context blocks (delay(), vTaskDelay() outside a task). Tasks are
+// coroutines on the main thread: runTasks() resumes each one whose wait
+// condition holds until none can make progress, so a run is single-threaded
+// and repeatable for a given seed and input script.
+namespace sim {
+
+// Clock and scheduler.
+uint64_t nowUs();
+void advanceUs(uint64_t us);
+void runTasks();
+
+// Boot seed: the firmware's randomSeed() call gets this in place of its
+// argument (as if the hardware RNG had produced it), and esp_random() is
+// seeded from it. Call before setup().
+void setSeed(uint32_t seed);
+uint32_t seed();
+
+// GPIO: pressed pulls an active-low button pin to LOW. A level change runs
+// the pin's attachInterrupt() handler immediately, as the GPIO ISR would.
+void setPinLevel(uint8_t pin, int level);
+void setButton(uint8_t pin, bool pressed);
+
+// Audio endpoints. The mic WAV (16-bit PCM, any channel count, first channel
+// used) loops; without one the mic reads silence. The speaker WAV records
+// every frame the TX DMA clocks out, including underrun silence.
+bool openMicWav(const char* path);
+bool openSpeakerWav(const char* path);
+void closeAudio();
+uint64_t speakerFrames();
+uint64_t speakerUnderrunFrames();
+
+// Storage and flash.
+void setFsRoot(const char* dir);
+bool loadAssetImage(const char* path);
+void setSerialSink(FILE* out);
+
+// Called each time the clock moves, after any timers due by then, including
+// while the firmware blocks or light-sleeps. InputScript drives the button
+// pins from here so presses land on time (and can wake the chip).
+void setClockHook(void (*fn)(void* ctx), void* ctx);
+
+// SSD1306 controller state: GDDRAM in page-major order (128 x 8 pages).
+static const int kPanelBytes = 1024;
+const uint8_t* panelFrame();
+uint64_t panelBusBytes();
+bool writePanelPbm(const char* path);
+
+}  // namespace sim
@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN
+} WStype_t;
+
+// Never connects (see WiFi.h); sends are accepted and discarded.
+class WebSocketsClient {
+public:
+  typedef void (*WebSocketClientEvent)(WStype_t type, uint8_t* payload, size_t length);
+
+  void onEvent(WebSocketClientEvent cb) { handler = cb; }
+  void setReconnectInterval(unsigned long) {}
+  void begin(const char*, uint16_t, const char* = "/") {}
+  void beginSSL(const char*, uint16_t, const char* = "/") {}
+  bool sendTXT(const char*) { return false; }
+  bool sendTXT(const String&) { return false; }
+  bool sendBIN(const uint8_t*, size_t) { return false; }
+  void disconnect() {}
+  void loop() {}
+
+private:
+  WebSocketClientEvent handler = nullptr;
+};
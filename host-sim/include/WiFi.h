@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+// There is no network in the sim: the station never associates.
+class WiFiClass {
+public:
+  void mode(int m) { currentMode = m; }
+  int status() { return WL_DISCONNECTED; }
+  void begin(const char*, const char* = nullptr) {}
+  void disconnect(bool = false) {}
+  void setSleep(bool) {}
+  IPAddress localIP() { return IPAddress(); }
+
+private:
+  int currentMode = WIFI_OFF;
+};
+extern WiFiClass WiFi;
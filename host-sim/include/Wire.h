@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+// I2C master. Every transaction is handed to the simulated SSD1306 (see
+// Sim.h) when it targets the panel's address; other addresses NACK.
+class TwoWire : public Print {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0);
+  void setClock(uint32_t freq) { clockHz = freq; }
+  void beginTransmission(uint8_t addr);
+  uint8_t endTransmission(bool stop = true);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t len) override;
+  using Print::print;
+
+private:
+  static const size_t kBufferSize = 128;   // matches the ESP32 core
+  uint32_t clockHz = 100000;
+  uint8_t txAddr = 0;
+  uint8_t txBuf[kBufferSize];
+  size_t txLen = 0;
+  bool txOverflow = false;
+};
+extern TwoWire Wire;
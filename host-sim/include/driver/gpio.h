@@ -0,0 +1,18 @@
+#pragma once
+#include "esp_system.h"
+
+// Only the light-sleep wake configuration; levels go through Arduino's
+// digitalRead()/GPIO registers.
+typedef int gpio_num_t;
+
+typedef enum {
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE = 1,
+  GPIO_INTR_NEGEDGE = 2,
+  GPIO_INTR_ANYEDGE = 3,
+  GPIO_INTR_LOW_LEVEL = 4,
+  GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type);
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio);
@@ -0,0 +1,76 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+
+// Legacy I2S driver. Each port keeps a DMA queue of dma_buf_count *
+// dma_buf_len frames that the sim clock drains (TX, into the speaker WAV)
+// or fills (RX, from the mic WAV) at the configured sample rate. Only
+// mono 16-bit TX and mono 32-bit RX are modelled, as the firmware uses.
+
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1 = 1, I2S_NUM_MAX } i2s_port_t;
+
+typedef enum {
+  I2S_MODE_MASTER = 1 << 0,
+  I2S_MODE_SLAVE = 1 << 1,
+  I2S_MODE_TX = 1 << 2,
+  I2S_MODE_RX = 1 << 3
+} i2s_mode_t;
+
+typedef enum {
+  I2S_BITS_PER_SAMPLE_16BIT = 16,
+  I2S_BITS_PER_SAMPLE_24BIT = 24,
+  I2S_BITS_PER_SAMPLE_32BIT = 32
+} i2s_bits_per_sample_t;
+
+typedef enum {
+  I2S_CHANNEL_FMT_RIGHT_LEFT,
+  I2S_CHANNEL_FMT_ALL_RIGHT,
+  I2S_CHANNEL_FMT_ALL_LEFT,
+  I2S_CHANNEL_FMT_ONLY_RIGHT,
+  I2S_CHANNEL_FMT_ONLY_LEFT
+} i2s_channel_fmt_t;
+
+typedef enum {
+  I2S_COMM_FORMAT_STAND_I2S = 0x01,
+  I2S_COMM_FORMAT_STAND_MSB = 0x02,
+  I2S_COMM_FORMAT_I2S = 0x01,
+  I2S_COMM_FORMAT_I2S_MSB = 0x01
+} i2s_comm_format_t;
+
+typedef enum { I2S_CHANNEL_MONO = 1, I2S_CHANNEL_STEREO = 2 } i2s_channel_t;
+
+#define I2S_PIN_NO_CHANGE (-1)
+
+typedef struct {
+  i2s_mode_t mode;
+  uint32_t sample_rate;
+  i2s_bits_per_sample_t bits_per_sample;
+  i2s_channel_fmt_t channel_format;
+  i2s_comm_format_t communication_format;
+  int intr_alloc_flags;
+  int dma_buf_count;
+  int dma_buf_len;
+  bool use_apll;
+  bool tx_desc_auto_clear;
+  int fixed_mclk;
+} i2s_config_t;
+
+typedef struct {
+  int bck_io_num;
+  int ws_io_num;
+  int data_out_num;
+  int data_in_num;
+} i2s_pin_config_t;
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* cfg, int queueSize,
+                             void* queue);
+esp_err_t i2s_driver_uninstall(i2s_port_t port);
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t* pins);
+esp_err_t i2s_set_clk(i2s_port_t port, uint32_t rate, i2s_bits_per_sample_t bits,
+                      i2s_channel_t ch);
+esp_err_t i2s_write(i2s_port_t port, const void* src, size_t size, size_t* written,
+                    TickType_t ticks);
+esp_err_t i2s_read(i2s_port_t port, void* dst, size_t size, size_t* read, TickType_t ticks);
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port);
@@ -0,0 +1,5 @@
+#pragma once
+#include "esp_system.h"
+
+#define ESP_BT_MODE_BTDM 3
+esp_err_t esp_bt_controller_mem_release(int mode);
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_system.h"
+
+// Only the "assets" partition exists, backed by the image given to
+// sim::loadAssetImage().
+typedef enum {
+  ESP_PARTITION_TYPE_APP = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+  ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef enum {
+  ESP_PARTITION_MMAP_DATA,
+  ESP_PARTITION_MMAP_INST
+} esp_partition_mmap_memory_t;
+
+typedef uint32_t esp_partition_mmap_handle_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  uint8_t subtype;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_mmap(const esp_partition_t* part, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory, const void** outPtr,
+                             esp_partition_mmap_handle_t* outHandle);
+void esp_partition_munmap(esp_partition_mmap_handle_t handle);
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+#include "esp_system.h"
+
+// Light sleep stops the clock-driven world: tasks and esp_timer callbacks
+// hold still while the sim clock runs on to the wake, which is the timer
+// or a pin reaching its gpio_wakeup_enable() level. Periodic timers skip
+// the periods they missed.
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+  ESP_SLEEP_WAKEUP_GPIO,
+} esp_sleep_source_t;
+typedef esp_sleep_source_t esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+esp_err_t esp_sleep_enable_gpio_wakeup();
+esp_err_t esp_light_sleep_start();
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
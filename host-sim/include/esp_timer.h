@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+#include "esp_system.h"
+
+// Sim clock in microseconds.
+int64_t esp_timer_get_time();
+
+// Timers fire at their exact due time as the sim clock passes it, from the
+// context that moved the clock (never from inside a task). Callbacks must
+// not block, as with ESP_TIMER_TASK dispatch on the device.
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+  ESP_TIMER_TASK,
+  ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
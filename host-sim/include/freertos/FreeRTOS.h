@@ -0,0 +1,38 @@
+#pragma once
+
+// Simulated FreeRTOS: tasks are cooperative coroutines driven by the sim
+// clock (see Sim.h), so a run is deterministic and single-threaded.
+
+#include <stdint.h>
+
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define portMAX_DELAY ((TickType_t)0xffffffffu)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void*), const char* name, uint32_t stackBytes,
+                                   void* arg, UBaseType_t prio, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+void xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t xTaskGetTickCount();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
@@ -0,0 +1,6 @@
+#pragma once
+
+// Placeholder credentials for the host build; the sim has no network.
+#define WIFI_SSID_STR "sim"
+#define WIFI_PASS_STR "sim"
+#define BRICKPHONE_TOKEN "sim"
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+// Input registers of the ESP32-S3 GPIO matrix: in holds GPIO0-31, in1 holds
+// GPIO32-53 in its low 22 bits. Kept in step with every simulated pin level.
+typedef struct {
+  union {
+    struct { uint32_t data : 32; };
+    uint32_t val;
+  } in;
+  union {
+    struct {
+      uint32_t data : 22;
+      uint32_t reserved22 : 10;
+    };
+    uint32_t val;
+  } in1;
+} gpio_dev_t;
+
+extern volatile gpio_dev_t GPIO;
@@ -0,0 +1,3 @@
+// Builds the sketch as an ordinary translation unit; the Arduino IDE does
+// the equivalent when it turns the .ino into a .cpp.
+#include "brickphone-fw.ino"
@@ -0,0 +1,89 @@
+#include "InputScript.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "InputRecorder.h"
+#include "Pins.h"
+#include "Sim.h"
+
+// Indexed by ButtonId.
+static const uint8_t kButtonPins[BTN_COUNT] = {
+  PIN_BTN_RIGHT, PIN_BTN_UP, PIN_BTN_DOWN, PIN_BTN_LEFT,
+  PIN_BTN_A, PIN_BTN_B, PIN_BTN_SELECT, PIN_BTN_START
+};
+
+bool InputScript::load(const char* path, std::string* error) {
+  FILE* fp = fopen(path, "r");
+  if (!fp) {
+    *error = std::string("cannot read ") + path;
+    return false;
+  }
+  events.clear();
+  next = 0;
+  seeded = false;
+
+  char line[128];
+  int lineNo = 0;
+  while (fgets(line, sizeof(line), fp)) {
+    lineNo++;
+    char* hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    char first[16];
+    char second[16];
+    char third[8];
+    int n = sscanf(line, "%15s %15s %7s", first, second, third);
+    if (n <= 0) continue;
+
+    bool ok = false;
+    if (n == 2 && strcmp(first, "seed") == 0) {
+      seedValue = (uint32_t)strtoul(second, nullptr, 10);
+      seeded = true;
+      ok = true;
+    } else if (n == 3) {
+      char* end = nullptr;
+      unsigned long ms = strtoul(first, &end, 10);
+      bool down = strcmp(third, "down") == 0;
+      bool up = strcmp(third, "up") == 0;
+      for (int b = 0; b < BTN_COUNT && *end == '\0' && (down || up); ++b) {
+        if (strcmp(second, InputRecorder::buttonName((ButtonId)b)) != 0) continue;
+        events.push_back({ ms, kButtonPins[b], down });
+        ok = true;
+      }
+    }
+    if (!ok) {
+      char where[32];
+      snprintf(where, sizeof(where), ":%d: ", lineNo);
+      *error = path + std::string(where) + "expected \"seed <n>\" or \"<ms> <BUTTON> down|up\"";
+      fclose(fp);
+      return false;
+    }
+  }
+  fclose(fp);
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event& a, const Event& b) { return a.atMs < b.atMs; });
+  return true;
+}
+
+InputScript::~InputScript() {
+  if (started) sim::setClockHook(nullptr, nullptr);
+}
+
+void InputScript::start() {
+  startUs = sim::nowUs();
+  next = 0;
+  started = true;
+  sim::setClockHook(onClock, this);
+  applyUntil(0);
+}
+
+void InputScript::onClock(void* ctx) {
+  InputScript* self = (InputScript*)ctx;
+  self->applyUntil((unsigned long)((sim::nowUs() - self->startUs) / 1000));
+}
+
+void InputScript::applyUntil(unsigned long runMs) {
+  for (; next < events.size() && events[next].atMs <= runMs; ++next) {
+    sim::setButton(events[next].pin, events[next].pressed);
+  }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// A button script as InputRecorder writes it: an optional "seed <n>" line,
+// then "<ms> <BUTTON> down|up" lines with ms counted from the end of
+// setup(). '#' starts a comment.
+class InputScript {
+public:
+  ~InputScript();
+  bool load(const char* path, std::string* error);
+  bool hasSeed() const { return seeded; }
+  uint32_t seed() const { return seedValue; }
+  size_t size() const { return events.size(); }
+
+  // Times count from this call. From then on the sim clock drives the
+  // pins (sim::setClockHook), so edges land on time even while the
+  // firmware blocks or sleeps.
+  void start();
+
+private:
+  static void onClock(void* ctx);
+  // Drives the button pins for every edge at or before runMs.
+  void applyUntil(unsigned long runMs);
+
+  struct Event {
+    unsigned long atMs;
+    uint8_t pin;
+    bool pressed;
+  };
+
+  std::vector<Event> events;
+  size_t next = 0;
+  uint64_t startUs = 0;
+  bool started = false;
+  bool seeded = false;
+  uint32_t seedValue = 0;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string.h>
+#include "ScreenManager.h"
+
+// Command-line names for the firmware's screens.
+struct ScreenName {
+  const char* name;
+  ScreenId id;
+};
+
+static const ScreenName kScreenNames[] = {
+  { "splash", ScreenId::Splash },
+  { "menu", ScreenId::Menu },
+  { "snake", ScreenId::Snake },
+  { "recorder", ScreenId::Recorder },
+  { "voice", ScreenId::Voice },
+  { "settings", ScreenId::Settings },
+  { "pong", ScreenId::Pong },
+  { "breakout", ScreenId::Breakout },
+  { "invaders", ScreenId::SpaceInvaders },
+  { "2048", ScreenId::Game2048 },
+  { "flappy", ScreenId::Flappy },
+};
+
+inline bool screenByName(const char* name, ScreenId* out) {
+  for (const ScreenName& s : kScreenNames) {
+    if (strcmp(s.name, name) != 0) continue;
+    *out = s.id;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,705 @@
+// Clock, cooperative FreeRTOS tasks and the Arduino core.
+
+// Task switches longjmp between coroutine stacks, which the fortified
+// longjmp rejects.
+#undef _FORTIFY_SOURCE
+
+#include <Arduino.h>
+#include <esp_bt.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <soc/gpio_struct.h>
+#include <WiFi.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <ucontext.h>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Sim.h"
+#include "SimInternal.h"
+
+using sim::detail::kForever;
+
+HWCDC Serial;
+EspClass ESP;
+WiFiClass WiFi;
+volatile gpio_dev_t GPIO;
+
+struct esp_timer {
+  esp_timer_cb_t callback = nullptr;
+  void* arg = nullptr;
+  uint64_t periodUs = 0;   // 0: one-shot
+  uint64_t dueUs = 0;
+  bool armed = false;
+};
+
+// ---------------------------------------------------------------------------
+// Clock and scheduler
+
+namespace {
+
+// One FreeRTOS tick; the clock never jumps further than this between
+// scheduler passes.
+const uint64_t kStepUs = 1000;
+// Host stacks for task coroutines. Firmware stack sizes are Xtensa bytes
+// and far too small for x86-64 frames with sanitizers or -O0.
+const size_t kTaskStackBytes = 256 * 1024;
+// Passes without every task blocking before runTasks() gives up.
+const int kMaxPasses = 100000;
+// The main context waiting this long on a condition with no deadline is a
+// deadlock in the firmware (or the sim).
+const uint64_t kMainStallUs = 10ull * 1000 * 1000;
+const UBaseType_t kLoopTaskStack = 8192;
+
+struct Task {
+  void (*fn)(void*) = nullptr;
+  void* arg = nullptr;
+  std::string name;
+  uint32_t stackBytes = 0;
+  jmp_buf env;
+  std::unique_ptr<uint8_t[]> stack;
+  uint32_t notify = 0;
+  const std::function<bool()>* ready = nullptr;
+  uint64_t deadline = kForever;
+  bool started = false;
+  bool dead = false;
+};
+
+uint64_t gNowUs = 0;
+std::vector<std::unique_ptr<Task>> gTasks;
+Task gLoopTask;            // stands in for the Arduino loop task
+Task* gCurrent = nullptr;  // null while the main context runs
+jmp_buf gSchedEnv;
+FILE* gSerialSink = nullptr;
+
+uint32_t gSeed = 1;
+bool gSeedPinned = false;
+uint64_t gRngState = 1;
+uint64_t gRandNext = 1;
+bool gUseHwRng = true;
+int gPinLevel[64];
+bool gPinsInit = false;
+std::vector<std::unique_ptr<esp_timer>> gTimers;
+void (*gClockHook)(void*) = nullptr;
+void* gClockHookCtx = nullptr;
+
+// Light sleep: per-pin wake level (-1 = none), armed sources, last cause.
+int gWakeLevel[64];
+bool gWakeLevelsInit = false;
+bool gGpioWake = false;
+uint64_t gSleepTimerUs = 0;
+bool gSleeping = false;
+esp_sleep_wakeup_cause_t gWakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+struct PinIsr {
+  void (*fn)(void*) = nullptr;
+  void (*plain)(void) = nullptr;
+  void* arg = nullptr;
+  int mode = 0;
+};
+PinIsr gPinIsr[64];
+
+// Mirrors one pin into the GPIO input registers.
+void latchPin(uint8_t pin) {
+  uint32_t bit = 1u << (pin & 31);
+  if (pin < 32) {
+    GPIO.in.val = gPinLevel[pin] ? (GPIO.in.val | bit) : (GPIO.in.val & ~bit);
+  } else if (pin < 54) {
+    GPIO.in1.val = gPinLevel[pin] ? (GPIO.in1.val | bit) : (GPIO.in1.val & ~bit);
+  }
+}
+
+void initPins() {
+  if (gPinsInit) return;
+  for (int pin = 0; pin < 64; ++pin) {
+    gPinLevel[pin] = HIGH;
+    latchPin((uint8_t)pin);
+  }
+  gPinsInit = true;
+}
+
+// Drives a pin and fires its edge handler, if any, on the spot.
+void drivePin(uint8_t pin, int level) {
+  initPins();
+  if (pin >= 64) return;
+  int prev = gPinLevel[pin];
+  gPinLevel[pin] = level;
+  latchPin(pin);
+  const PinIsr& isr = gPinIsr[pin];
+  if (prev == level || isr.mode == 0) return;
+  bool rising = level == HIGH;
+  if (isr.mode == CHANGE || (isr.mode == RISING && rising) || (isr.mode == FALLING && !rising)) {
+    if (isr.fn) isr.fn(isr.arg);
+    else if (isr.plain) isr.plain();
+  }
+}
+
+bool isLive(TaskHandle_t handle) {
+  if (handle == &gLoopTask) return true;
+  for (auto& t : gTasks) {
+    if (t.get() == handle) return !t->dead;
+  }
+  return false;
+}
+
+// Saves the running task and returns to runTasks(). _setjmp/_longjmp skip
+// the signal-mask syscall that swapcontext makes on every switch; a
+// ucontext is only used once per task, to enter its stack.
+void yieldToScheduler(Task* t) {
+  if (_setjmp(t->env) == 0) _longjmp(gSchedEnv, 1);
+}
+
+void taskEntry() {
+  Task* t = gCurrent;
+  t->fn(t->arg);
+  // FreeRTOS asserts when a task function returns; treat it as a delete.
+  t->dead = true;
+  _longjmp(gSchedEnv, 1);
+}
+
+bool runnable(const Task& t) {
+  if (t.dead) return false;
+  if (!t.started) return true;
+  if (gNowUs >= t.deadline) return true;
+  return t.ready && (*t.ready)();
+}
+
+void resume(Task* t) {
+  gCurrent = t;
+  if (_setjmp(gSchedEnv) == 0) {
+    if (t->started) _longjmp(t->env, 1);
+    t->started = true;
+    ucontext_t entry;
+    getcontext(&entry);
+    entry.uc_stack.ss_sp = t->stack.get();
+    entry.uc_stack.ss_size = kTaskStackBytes;
+    entry.uc_link = nullptr;
+    makecontext(&entry, taskEntry, 0);
+    setcontext(&entry);
+  }
+  gCurrent = nullptr;
+  if (t->dead) t->stack.reset();
+}
+
+esp_timer* nextDueTimer(uint64_t byUs) {
+  esp_timer* next = nullptr;
+  for (auto& t : gTimers) {
+    if (!t->armed || t->dueUs > byUs) continue;
+    if (!next || t->dueUs < next->dueUs) next = t.get();
+  }
+  return next;
+}
+
+// Moves the clock, stopping at each timer deadline on the way so callbacks
+// see their exact due time. Timers hold off while the chip light-sleeps.
+void stepClock(uint64_t us) {
+  uint64_t endUs = gNowUs + us;
+  while (esp_timer* t = gSleeping ? nullptr : nextDueTimer(endUs)) {
+    if (t->dueUs > gNowUs) {
+      gNowUs = t->dueUs;
+      sim::detail::i2sAdvance(gNowUs);
+    }
+    if (t->periodUs) t->dueUs += t->periodUs;
+    else t->armed = false;
+    t->callback(t->arg);   // may stop or delete t
+  }
+  gNowUs = endUs;
+  sim::detail::i2sAdvance(gNowUs);
+  if (gClockHook) gClockHook(gClockHookCtx);
+}
+
+void initWakeLevels() {
+  if (gWakeLevelsInit) return;
+  for (int& level : gWakeLevel) level = -1;
+  gWakeLevelsInit = true;
+}
+
+bool gpioWakeHeld() {
+  if (!gGpioWake || !gWakeLevelsInit) return false;
+  for (int pin = 0; pin < 64; ++pin) {
+    if (gWakeLevel[pin] >= 0 && gPinLevel[pin] == gWakeLevel[pin]) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+namespace sim {
+
+uint64_t nowUs() { return gNowUs; }
+
+void runTasks() {
+  if (gCurrent) return;
+  for (int pass = 0; pass < kMaxPasses; ++pass) {
+    bool progressed = false;
+    // Indexed: a task may create another one.
+    for (size_t i = 0; i < gTasks.size(); ++i) {
+      Task* t = gTasks[i].get();
+      if (!runnable(*t)) continue;
+      resume(t);
+      progressed = true;
+    }
+    if (!progressed) return;
+  }
+  fprintf(stderr, "sim: a task never blocks at t=%llu us\n", (unsigned long long)gNowUs);
+}
+
+void advanceUs(uint64_t us) {
+  runTasks();
+  while (us > 0) {
+    uint64_t step = us < kStepUs ? us : kStepUs;
+    stepClock(step);
+    runTasks();
+    us -= step;
+  }
+}
+
+void setSeed(uint32_t s) {
+  gSeed = s ? s : 1;
+  gSeedPinned = true;
+  gRngState = gSeed;
+}
+
+uint32_t seed() { return gSeed; }
+
+void setPinLevel(uint8_t pin, int level) {
+  drivePin(pin, level ? HIGH : LOW);
+}
+
+void setButton(uint8_t pin, bool pressed) {
+  setPinLevel(pin, pressed ? LOW : HIGH);
+}
+
+void setSerialSink(FILE* out) { gSerialSink = out; }
+
+void setClockHook(void (*fn)(void* ctx), void* ctx) {
+  gClockHook = fn;
+  gClockHookCtx = ctx;
+}
+
+namespace detail {
+
+bool inTask() { return gCurrent != nullptr; }
+
+bool waitUntil(const std::function<bool()>& ready, uint64_t deadlineUs) {
+  if (ready()) return true;
+  if (gCurrent) {
+    Task* t = gCurrent;
+    t->ready = &ready;
+    t->deadline = deadlineUs;
+    yieldToScheduler(t);
+    t->ready = nullptr;
+    t->deadline = kForever;
+    return ready();
+  }
+
+  uint64_t stallAt = gNowUs + kMainStallUs;
+  for (;;) {
+    runTasks();
+    if (ready()) return true;
+    if (gNowUs >= deadlineUs) return false;
+    if (deadlineUs == kForever && gNowUs >= stallAt) {
+      fprintf(stderr, "sim: main context stuck waiting at t=%llu us\n",
+              (unsigned long long)gNowUs);
+      abort();
+    }
+    uint64_t step = kStepUs;
+    if (deadlineUs != kForever && deadlineUs - gNowUs < step) step = deadlineUs - gNowUs;
+    stepClock(step);
+  }
+}
+
+}  // namespace detail
+}  // namespace sim
+
+// ---------------------------------------------------------------------------
+// FreeRTOS
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void*), const char* name, uint32_t stackBytes,
+                                   void* arg, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  std::unique_ptr<Task> t(new Task);
+  t->fn = fn;
+  t->arg = arg;
+  t->name = name ? name : "";
+  t->stackBytes = stackBytes;
+  t->stack.reset(new uint8_t[kTaskStackBytes]);
+  if (handle) *handle = t.get();
+  gTasks.push_back(std::move(t));
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  static const std::function<bool()> never = [] { return false; };
+  sim::detail::waitUntil(never, gNowUs + (uint64_t)ticks * 1000);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  Task* t = static_cast<Task*>(task ? task : gCurrent);
+  if (!t || t == &gLoopTask) return;
+  t->dead = true;
+  if (t == gCurrent) _longjmp(gSchedEnv, 1);
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  if (isLive(task)) static_cast<Task*>(task)->notify++;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+  xTaskNotifyGive(task);
+  if (woken) *woken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  Task* self = gCurrent ? gCurrent : &gLoopTask;
+  uint64_t deadline = ticks == portMAX_DELAY ? kForever : gNowUs + (uint64_t)ticks * 1000;
+  std::function<bool()> pending = [self] { return self->notify > 0; };
+  if (!sim::detail::waitUntil(pending, deadline)) return 0;
+  uint32_t value = self->notify;
+  self->notify = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return gCurrent ? static_cast<TaskHandle_t>(gCurrent) : &gLoopTask;
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(gNowUs / 1000); }
+
+// Host stack use says nothing about the Xtensa build, so this reports the
+// configured size rather than a measurement.
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  Task* t = static_cast<Task*>(task ? task : xTaskGetCurrentTaskHandle());
+  return t == &gLoopTask ? kLoopTaskStack : t->stackBytes;
+}
+
+// ---------------------------------------------------------------------------
+// Arduino core
+
+unsigned long millis() { return (unsigned long)(gNowUs / 1000); }
+unsigned long micros() { return (unsigned long)gNowUs; }
+int64_t esp_timer_get_time() { return (int64_t)gNowUs; }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  if (!args || !args->callback || !out) return ESP_FAIL;
+  std::unique_ptr<esp_timer> t(new esp_timer);
+  t->callback = args->callback;
+  t->arg = args->arg;
+  *out = t.get();
+  gTimers.push_back(std::move(t));
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+  if (!timer || timer->armed) return ESP_FAIL;
+  timer->periodUs = 0;
+  timer->dueUs = gNowUs + timeoutUs;
+  timer->armed = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+  if (!timer || timer->armed || periodUs == 0) return ESP_FAIL;
+  timer->periodUs = periodUs;
+  timer->dueUs = gNowUs + periodUs;
+  timer->armed = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer || !timer->armed) return ESP_FAIL;
+  timer->armed = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  for (size_t i = 0; i < gTimers.size(); ++i) {
+    if (gTimers[i].get() != timer) continue;
+    if (timer->armed) return ESP_FAIL;
+    gTimers.erase(gTimers.begin() + i);
+    return ESP_OK;
+  }
+  return ESP_FAIL;
+}
+
+void delay(unsigned long ms) { vTaskDelay((TickType_t)ms); }
+
+// ---------------------------------------------------------------------------
+// Light sleep
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type) {
+  if (gpio < 0 || gpio >= 64) return ESP_FAIL;
+  if (type != GPIO_INTR_LOW_LEVEL && type != GPIO_INTR_HIGH_LEVEL) return ESP_FAIL;
+  initWakeLevels();
+  gWakeLevel[gpio] = type == GPIO_INTR_HIGH_LEVEL ? HIGH : LOW;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio) {
+  if (gpio < 0 || gpio >= 64) return ESP_FAIL;
+  initWakeLevels();
+  gWakeLevel[gpio] = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+  gSleepTimerUs = timeUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  gGpioWake = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  // The device suspends every task; here only the main context can sleep.
+  if (gCurrent) return ESP_FAIL;
+  initPins();
+  uint64_t wakeAt = gSleepTimerUs ? gNowUs + gSleepTimerUs : kForever;
+  if (wakeAt == kForever && !gGpioWake) return ESP_FAIL;
+  uint64_t stallAt = gNowUs + kMainStallUs;
+  gSleeping = true;
+  for (;;) {
+    if (gpioWakeHeld()) {
+      gWakeCause = ESP_SLEEP_WAKEUP_GPIO;
+      break;
+    }
+    if (gNowUs >= wakeAt) {
+      gWakeCause = ESP_SLEEP_WAKEUP_TIMER;
+      break;
+    }
+    if (wakeAt == kForever && gNowUs >= stallAt) {
+      fprintf(stderr, "sim: light sleep with no wake in sight at t=%llu us\n",
+              (unsigned long long)gNowUs);
+      abort();
+    }
+    uint64_t step = kStepUs;
+    if (wakeAt != kForever && wakeAt - gNowUs < step) step = wakeAt - gNowUs;
+    stepClock(step);
+  }
+  gSleeping = false;
+  for (auto& t : gTimers) {
+    if (!t->armed || !t->periodUs || t->dueUs > gNowUs) continue;
+    t->dueUs += ((gNowUs - t->dueUs) / t->periodUs + 1) * t->periodUs;
+  }
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return gWakeCause; }
+
+void pinMode(uint8_t, uint8_t) { initPins(); }
+
+int digitalRead(uint8_t pin) {
+  initPins();
+  return pin < 64 ? gPinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  drivePin(pin, val ? HIGH : LOW);
+}
+
+void attachInterrupt(uint8_t pin, void (*fn)(void), int mode) {
+  if (pin >= 64) return;
+  gPinIsr[pin] = PinIsr();
+  gPinIsr[pin].plain = fn;
+  gPinIsr[pin].mode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*fn)(void*), void* arg, int mode) {
+  if (pin >= 64) return;
+  gPinIsr[pin] = PinIsr();
+  gPinIsr[pin].fn = fn;
+  gPinIsr[pin].arg = arg;
+  gPinIsr[pin].mode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < 64) gPinIsr[pin] = PinIsr();
+}
+
+// splitmix64: stands in for the hardware RNG so runs repeat per seed.
+uint32_t esp_random() {
+  uint64_t z = (gRngState += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+// After randomSeed(), Arduino-ESP32 draws from newlib's rand(); this is the
+// same LCG and the same multiply-shift mapping as its WMath.cpp, so a seed
+// recorded on the device gives the same sequence here.
+static uint32_t newlibRand() {
+  gRandNext = gRandNext * 6364136223846793005ull + 1;
+  return (uint32_t)((gRandNext >> 32) & 0x7FFFFFFF);
+}
+
+long random(long howBig) {
+  if (howBig == 0) return 0;
+  if (howBig < 0) return random(0, -howBig);
+  uint32_t range = (uint32_t)howBig;
+  uint32_t x = gUseHwRng ? esp_random() : newlibRand();
+  uint64_t m = (uint64_t)x * range;
+  uint32_t l = (uint32_t)m;
+  if (l < range) {
+    uint32_t t = -range;
+    if (t >= range) {
+      t -= range;
+      if (t >= range) t %= range;
+    }
+    while (l < t) {
+      x = gUseHwRng ? esp_random() : newlibRand();
+      m = (uint64_t)x * range;
+      l = (uint32_t)m;
+    }
+  }
+  return (long)(m >> 32);
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) return howSmall;
+  return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long s) {
+  if (s == 0) return;
+  gRandNext = gSeedPinned ? gSeed : s;
+  gUseHwRng = false;
+}
+
+String::String(float v, unsigned int decimals) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, (double)v);
+  str = buf;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) std::swap(from, to);
+  if (from >= str.size()) return String();
+  return String(str.substr(from, to - from));
+}
+
+size_t Print::printf(const char* fmt, ...) {
+  char small[128];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(small, sizeof(small), fmt, ap);
+  va_end(ap);
+  if (n < 0) return 0;
+  if ((size_t)n < sizeof(small)) return write((const uint8_t*)small, n);
+  std::vector<char> big(n + 1);
+  va_start(ap, fmt);
+  vsnprintf(big.data(), big.size(), fmt, ap);
+  va_end(ap);
+  return write((const uint8_t*)big.data(), n);
+}
+
+size_t HWCDC::write(uint8_t c) { return write(&c, 1); }
+
+size_t HWCDC::write(const uint8_t* data, size_t len) {
+  if (gSerialSink) fwrite(data, 1, len, gSerialSink);
+  return len;
+}
+
+uint32_t EspClass::getCycleCount() {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  return (uint32_t)((uint64_t)ns * getCpuFreqMHz() / 1000);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+}
+
+void esp_restart() {
+  fprintf(stderr, "sim: esp_restart() at t=%llu us\n", (unsigned long long)gNowUs);
+  exit(0);
+}
+
+esp_err_t esp_bt_controller_mem_release(int) { return ESP_OK; }
+
+// ---------------------------------------------------------------------------
+// heap_caps: host allocations charged to ESP32-S3-sized pools.
+
+namespace {
+
+struct Pool {
+  size_t total;
+  size_t used;
+  size_t peak;
+};
+
+// Roughly what an idle Arduino-ESP32 sketch has left of internal RAM, and
+// an 8 MB PSRAM.
+Pool gInternal = { 300 * 1024, 0, 0 };
+Pool gPsram = { 8 * 1024 * 1024, 0, 0 };
+
+struct Block {
+  size_t size;
+  Pool* pool;
+};
+std::unordered_map<void*, Block>& blocks() {
+  static std::unordered_map<void*, Block> map;
+  return map;
+}
+
+Pool* poolFor(uint32_t caps) {
+  return (caps & MALLOC_CAP_SPIRAM) ? &gPsram : &gInternal;
+}
+
+void* track(void* p, size_t size, Pool* pool) {
+  if (!p) return nullptr;
+  pool->used += size;
+  if (pool->used > pool->peak) pool->peak = pool->used;
+  blocks()[p] = Block{ size, pool };
+  return p;
+}
+
+}  // namespace
+
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+  Pool* pool = poolFor(caps);
+  if (size == 0 || size > pool->total - pool->used) return nullptr;
+  if (alignment < sizeof(void*)) alignment = sizeof(void*);
+  size_t rounded = (size + alignment - 1) / alignment * alignment;
+  return track(aligned_alloc(alignment, rounded), size, pool);
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+  return heap_caps_aligned_alloc(alignof(max_align_t), size, caps);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  if (size && n > SIZE_MAX / size) return nullptr;
+  void* p = heap_caps_malloc(n * size, caps);
+  if (p) memset(p, 0, n * size);
+  return p;
+}
+
+void heap_caps_free(void* ptr) {
+  if (!ptr) return;
+  auto it = blocks().find(ptr);
+  if (it != blocks().end()) {
+    it->second.pool->used -= it->second.size;
+    blocks().erase(it);
+  }
+  free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  Pool* pool = poolFor(caps);
+  return pool->total - pool->used;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  Pool* pool = poolFor(caps);
+  return pool->total - pool->peak;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps);
+}
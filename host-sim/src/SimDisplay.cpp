@@ -0,0 +1,376 @@
+// I2C bus, an SSD1306 controller model, and the Adafruit GFX/SSD1306 API on
+// top of it.
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <Wire.h>
+#include <stdlib.h>
+#include "Sim.h"
+#include "SimInternal.h"
+
+TwoWire Wire;
+
+namespace {
+
+const uint8_t kPanelAddr = 0x3C;
+const int kCols = 128;
+const int kPages = 8;
+
+// Only what DisplayService and Adafruit_SSD1306 drive: horizontal
+// addressing, column/page windows and GDDRAM writes. Everything else is
+// parsed for its argument count and ignored.
+struct Ssd1306 {
+  uint8_t ram[kCols * kPages] = {};
+  uint8_t col0 = 0, col1 = kCols - 1;
+  uint8_t page0 = 0, page1 = kPages - 1;
+  uint8_t col = 0, page = 0;
+  uint8_t cmd = 0;
+  uint8_t args[6];
+  int argsHave = 0;
+  int argsWant = 0;
+  uint64_t busBytes = 0;
+
+  static int argCount(uint8_t c) {
+    switch (c) {
+      case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+      case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+      case 0x21: case 0x22: case 0xA3:
+        return 2;
+      case 0x29: case 0x2A:
+        return 5;
+      case 0x26: case 0x27:
+        return 6;
+      default:
+        return 0;
+    }
+  }
+
+  void command(uint8_t b) {
+    if (argsWant > argsHave) {
+      args[argsHave++] = b;
+      if (argsHave == argsWant) apply();
+      return;
+    }
+    cmd = b;
+    argsHave = 0;
+    argsWant = argCount(b);
+    if (argsWant == 0) apply();
+  }
+
+  void apply() {
+    if (cmd == 0x21) {
+      col0 = args[0] & 0x7F;
+      col1 = args[1] & 0x7F;
+      col = col0;
+    } else if (cmd == 0x22) {
+      page0 = args[0] & 0x07;
+      page1 = args[1] & 0x07;
+      page = page0;
+    }
+  }
+
+  void data(uint8_t b) {
+    ram[page * kCols + col] = b;
+    if (col < col1) {
+      col++;
+      return;
+    }
+    col = col0;
+    page = page < page1 ? page + 1 : page0;
+  }
+
+  // One I2C write: control byte, then commands or GDDRAM data.
+  void transaction(const uint8_t* buf, size_t len) {
+    busBytes += len;
+    size_t i = 0;
+    while (i < len) {
+      uint8_t control = buf[i++];
+      bool isData = control & 0x40;
+      bool single = control & 0x80;   // Co: one byte, then another control byte
+      size_t end = single ? (i + 1 < len ? i + 1 : len) : len;
+      for (; i < end; ++i) {
+        if (isData) data(buf[i]);
+        else command(buf[i]);
+      }
+    }
+  }
+};
+
+Ssd1306 gPanel;
+
+// Classic 5x7 ASCII font, 0x20..0x7E, one byte per column, LSB at the top.
+const uint8_t kFont[95][5] = {
+  {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+  {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+  {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+  {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+  {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+  {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+  {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+  {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+  {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+  {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+  {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+  {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+  {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+  {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+  {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+  {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+  {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+  {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+  {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+  {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+  {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+  {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+  {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+  {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+  {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+  {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+  {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+  {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+  {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+  {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+  {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+  {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+}  // namespace
+
+namespace sim {
+
+const uint8_t* panelFrame() { return gPanel.ram; }
+uint64_t panelBusBytes() { return gPanel.busBytes; }
+
+bool writePanelPbm(const char* path) {
+  FILE* fp = fopen(path, "wb");
+  if (!fp) return false;
+  fprintf(fp, "P1\n%d %d\n", kCols, kPages * 8);
+  for (int y = 0; y < kPages * 8; ++y) {
+    for (int x = 0; x < kCols; ++x) {
+      int on = (gPanel.ram[(y / 8) * kCols + x] >> (y & 7)) & 1;
+      fputc(on ? '1' : '0', fp);
+      fputc(x + 1 < kCols ? ' ' : '\n', fp);
+    }
+  }
+  return fclose(fp) == 0;
+}
+
+}  // namespace sim
+
+// ---------------------------------------------------------------------------
+// TwoWire
+
+bool TwoWire::begin(int, int, uint32_t freq) {
+  if (freq) clockHz = freq;
+  return true;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  txAddr = addr;
+  txLen = 0;
+  txOverflow = false;
+}
+
+size_t TwoWire::write(uint8_t c) {
+  if (txLen >= kBufferSize) {
+    txOverflow = true;
+    return 0;
+  }
+  txBuf[txLen++] = c;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+  size_t n = 0;
+  while (n < len && write(data[n])) n++;
+  return n;
+}
+
+// Returns the Arduino error codes: 2 = address NACK, 4 = buffer overflow.
+// The caller is held for the bus time (9 clocks per byte plus address), so
+// a flush task costs what it would on the wire.
+uint8_t TwoWire::endTransmission(bool) {
+  if (txOverflow) return 4;
+  uint64_t busUs = (uint64_t)(txLen + 1) * 9 * 1000000 / (clockHz ? clockHz : 100000);
+  uint64_t doneAt = sim::nowUs() + busUs;
+  if (txAddr != kPanelAddr) return 2;
+  gPanel.transaction(txBuf, txLen);
+  txLen = 0;
+  static const std::function<bool()> never = [] { return false; };
+  sim::detail::waitUntil(never, doneAt);
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Adafruit_GFX
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < w; ++i) {
+    drawPixel(x + i, y, color);
+    drawPixel(x + i, y + h - 1, color);
+  }
+  for (int16_t j = 1; j < h - 1; ++j) {
+    drawPixel(x, y + j, color);
+    drawPixel(x + w - 1, y + j, color);
+  }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t j = 0; j < h; ++j) {
+    for (int16_t i = 0; i < w; ++i) drawPixel(x + i, y + j, color);
+  }
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h,
+                              uint16_t color) {
+  int16_t byteWidth = (w + 7) / 8;
+  for (int16_t j = 0; j < h; ++j) {
+    for (int16_t i = 0; i < w; ++i) {
+      if (bitmap[j * byteWidth + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, color);
+    }
+  }
+}
+
+// color == bg draws transparently, as in the library.
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                            uint8_t size) {
+  if (c < 0x20 || c > 0x7E) c = '?';
+  const uint8_t* glyph = kFont[c - 0x20];
+  for (int8_t i = 0; i < 6; ++i) {
+    uint8_t line = i < 5 ? glyph[i] : 0;
+    for (int8_t j = 0; j < 8; ++j, line >>= 1) {
+      uint16_t ink;
+      if (line & 1) ink = color;
+      else if (bg != color) ink = bg;
+      else continue;
+      if (size == 1) drawPixel(x + i, y + j, ink);
+      else fillRect(x + i * size, y + j * size, size, size, ink);
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursorX = 0;
+    cursorY += textSize * 8;
+    return 1;
+  }
+  if (c == '\r') return 1;
+  if (wrap && cursorX + textSize * 6 > WIDTH) {
+    cursorX = 0;
+    cursorY += textSize * 8;
+  }
+  drawChar(cursorX, cursorY, c, textColor, textColor, textSize);
+  cursorX += textSize * 6;
+  return 1;
+}
+
+void Adafruit_GFX::getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1,
+                                 int16_t* y1, uint16_t* w, uint16_t* h) {
+  int16_t cx = x;
+  int16_t cy = y;
+  int16_t maxX = x;
+  int16_t maxY = y;
+  bool any = false;
+  for (const char* p = text; p && *p; ++p) {
+    if (*p == '\n') {
+      cx = x;
+      cy += textSize * 8;
+      continue;
+    }
+    if (*p == '\r') continue;
+    if (wrap && cx + textSize * 6 > WIDTH) {
+      cx = 0;
+      cy += textSize * 8;
+    }
+    cx += textSize * 6;
+    if (cx > maxX) maxX = cx;
+    if (cy + textSize * 8 > maxY) maxY = cy + textSize * 8;
+    any = true;
+  }
+  *x1 = x;
+  *y1 = y;
+  *w = any ? (uint16_t)(maxX - x) : 0;
+  *h = any ? (uint16_t)(maxY - y) : 0;
+}
+
+// ---------------------------------------------------------------------------
+// GFXcanvas1: row-major, MSB first.
+
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  buffer = static_cast<uint8_t*>(calloc((size_t)((w + 7) / 8) * h, 1));
+}
+
+GFXcanvas1::~GFXcanvas1() { free(buffer); }
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (!buffer || x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+  uint8_t* p = &buffer[y * ((WIDTH + 7) / 8) + x / 8];
+  uint8_t bit = 0x80 >> (x & 7);
+  if (color) *p |= bit;
+  else *p &= ~bit;
+}
+
+void GFXcanvas1::fillScreen(uint16_t color) {
+  if (buffer) memset(buffer, color ? 0xFF : 0x00, (size_t)((WIDTH + 7) / 8) * HEIGHT);
+}
+
+bool GFXcanvas1::getPixel(int16_t x, int16_t y) const {
+  if (!buffer || x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return false;
+  return buffer[y * ((WIDTH + 7) / 8) + x / 8] & (0x80 >> (x & 7));
+}
+
+// ---------------------------------------------------------------------------
+// Adafruit_SSD1306
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t)
+  : Adafruit_GFX(w, h), wire(twi ? twi : &Wire) {}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t addr, bool, bool) {
+  if (!buffer) buffer = static_cast<uint8_t*>(calloc((size_t)WIDTH * HEIGHT / 8, 1));
+  if (!buffer) return false;
+  i2caddr = addr;
+  wire->beginTransmission(addr);
+  return wire->endTransmission() == 0;
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x00);
+  wire->write(c);
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::display() {
+  static const uint8_t kWindow[] = {
+    0x00, SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, 127
+  };
+  wire->beginTransmission(i2caddr);
+  wire->write(kWindow, sizeof(kWindow));
+  wire->endTransmission();
+
+  size_t total = (size_t)WIDTH * HEIGHT / 8;
+  for (size_t off = 0; off < total; off += 64) {
+    size_t chunk = total - off < 64 ? total - off : 64;
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x40);
+    wire->write(buffer + off, chunk);
+    wire->endTransmission();
+  }
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  if (buffer) memset(buffer, 0, (size_t)WIDTH * HEIGHT / 8);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (!buffer || x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+  uint8_t* p = &buffer[x + (y / 8) * WIDTH];
+  uint8_t bit = 1 << (y & 7);
+  switch (color) {
+    case SSD1306_WHITE: *p |= bit; break;
+    case SSD1306_BLACK: *p &= ~bit; break;
+    case SSD1306_INVERSE: *p ^= bit; break;
+  }
+}
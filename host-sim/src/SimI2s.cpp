@@ -0,0 +1,287 @@
+// I2S ports clocked by the sim, with WAV files as the mic and speaker.
+
+#include <driver/i2s.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "Sim.h"
+#include "SimInternal.h"
+
+using sim::detail::kForever;
+
+namespace {
+
+struct Port {
+  bool installed = false;
+  bool tx = false;
+  uint32_t rate = 0;
+  int bytesPerFrame = 2;
+  size_t capacity = 0;     // frames the DMA descriptors hold
+  size_t dmaFrames = 0;    // frames per descriptor
+  uint64_t startUs = 0;
+  uint64_t clocked = 0;    // frames clocked in or out since install
+  std::deque<int32_t> queue;
+};
+
+Port gPorts[I2S_NUM_MAX];
+
+// 16-bit PCM WAV, read looping (mic) or written with a header patched on
+// close (speaker).
+struct WavIn {
+  std::vector<int16_t> samples;
+  size_t pos = 0;
+};
+
+struct WavOut {
+  FILE* fp = nullptr;
+  uint32_t rate = 0;
+  uint64_t frames = 0;
+  uint64_t underruns = 0;
+};
+
+WavIn gMic;
+WavOut gSpeaker;
+
+uint32_t readLe(const uint8_t* p, int n) {
+  uint32_t v = 0;
+  for (int i = n - 1; i >= 0; --i) v = (v << 8) | p[i];
+  return v;
+}
+
+void putLe(uint8_t* p, uint32_t v, int n) {
+  for (int i = 0; i < n; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+void writeWavHeader(FILE* fp, uint32_t rate, uint32_t frames) {
+  uint8_t h[44];
+  memcpy(h, "RIFF", 4);
+  putLe(h + 4, 36 + frames * 2, 4);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  putLe(h + 16, 16, 4);
+  putLe(h + 20, 1, 2);          // PCM
+  putLe(h + 22, 1, 2);          // mono
+  putLe(h + 24, rate, 4);
+  putLe(h + 28, rate * 2, 4);
+  putLe(h + 32, 2, 2);
+  putLe(h + 34, 16, 2);
+  memcpy(h + 36, "data", 4);
+  putLe(h + 40, frames * 2, 4);
+  fseek(fp, 0, SEEK_SET);
+  fwrite(h, 1, sizeof(h), fp);
+  fseek(fp, 0, SEEK_END);
+}
+
+void speakerOut(int16_t s, bool underrun) {
+  if (!gSpeaker.fp) return;
+  putc(s & 0xFF, gSpeaker.fp);
+  putc((s >> 8) & 0xFF, gSpeaker.fp);
+  gSpeaker.frames++;
+  if (underrun) gSpeaker.underruns++;
+}
+
+int16_t micIn() {
+  if (gMic.samples.empty()) return 0;
+  int16_t s = gMic.samples[gMic.pos];
+  gMic.pos = (gMic.pos + 1) % gMic.samples.size();
+  return s;
+}
+
+Port* portFor(i2s_port_t port) {
+  if ((int)port < 0 || port >= I2S_NUM_MAX) return nullptr;
+  return gPorts[port].installed ? &gPorts[port] : nullptr;
+}
+
+uint64_t deadlineFor(TickType_t ticks) {
+  if (ticks == portMAX_DELAY) return kForever;
+  return sim::nowUs() + (uint64_t)ticks * 1000;
+}
+
+}  // namespace
+
+namespace sim {
+
+bool openMicWav(const char* path) {
+  FILE* fp = fopen(path, "rb");
+  if (!fp) return false;
+  std::vector<uint8_t> bytes;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+  fclose(fp);
+
+  if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 ||
+      memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+    return false;
+  }
+  int channels = 0;
+  int bits = 0;
+  size_t off = 12;
+  while (off + 8 <= bytes.size()) {
+    uint32_t len = readLe(&bytes[off + 4], 4);
+    const uint8_t* body = &bytes[off + 8];
+    if (memcmp(&bytes[off], "fmt ", 4) == 0 && len >= 16) {
+      channels = (int)readLe(body + 2, 2);
+      bits = (int)readLe(body + 14, 2);
+    } else if (memcmp(&bytes[off], "data", 4) == 0) {
+      if (bits != 16 || channels < 1) return false;
+      size_t avail = bytes.size() - off - 8;
+      if (len > avail) len = (uint32_t)avail;
+      size_t frames = len / (2 * channels);
+      gMic.samples.resize(frames);
+      for (size_t i = 0; i < frames; ++i) {
+        gMic.samples[i] = (int16_t)readLe(body + i * 2 * channels, 2);
+      }
+      gMic.pos = 0;
+      return true;
+    }
+    off += 8 + len + (len & 1);
+  }
+  return false;
+}
+
+bool openSpeakerWav(const char* path) {
+  FILE* fp = fopen(path, "wb");
+  if (!fp) return false;
+  gSpeaker.fp = fp;
+  gSpeaker.frames = 0;
+  gSpeaker.underruns = 0;
+  writeWavHeader(fp, 24000, 0);
+  return true;
+}
+
+void closeAudio() {
+  if (gSpeaker.fp) {
+    uint32_t rate = gSpeaker.rate ? gSpeaker.rate : 24000;
+    writeWavHeader(gSpeaker.fp, rate, (uint32_t)gSpeaker.frames);
+    fclose(gSpeaker.fp);
+    gSpeaker.fp = nullptr;
+  }
+  gMic.samples.clear();
+}
+
+uint64_t speakerFrames() { return gSpeaker.frames; }
+uint64_t speakerUnderrunFrames() { return gSpeaker.underruns; }
+
+namespace detail {
+
+// TX ports clock frames out of the queue (silence when it runs dry); RX
+// ports clock frames in and drop the oldest once the descriptors are full,
+// as the driver does on overflow.
+void i2sAdvance(uint64_t nowUs) {
+  for (Port& p : gPorts) {
+    if (!p.installed) continue;
+    uint64_t due = (nowUs - p.startUs) * p.rate / 1000000;
+    size_t n = (size_t)(due - p.clocked);
+    p.clocked = due;
+    if (n == 0) continue;
+    if (p.tx) {
+      size_t played = n < p.queue.size() ? n : p.queue.size();
+      if (gSpeaker.fp) {
+        for (size_t i = 0; i < played; ++i) speakerOut((int16_t)p.queue[i], false);
+        for (size_t i = played; i < n; ++i) speakerOut(0, true);
+      }
+      p.queue.erase(p.queue.begin(), p.queue.begin() + played);
+    } else {
+      // Scaled so MicConvert's >> 14 gives back the WAV sample.
+      for (size_t i = 0; i < n; ++i) p.queue.push_back((int32_t)micIn() * (1 << 14));
+      if (p.queue.size() > p.capacity) {
+        p.queue.erase(p.queue.begin(), p.queue.end() - p.capacity);
+      }
+    }
+  }
+}
+
+}  // namespace detail
+}  // namespace sim
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* cfg, int, void*) {
+  if ((int)port < 0 || port >= I2S_NUM_MAX || !cfg) return ESP_FAIL;
+  Port& p = gPorts[port];
+  if (p.installed) return ESP_FAIL;
+  p = Port();
+  p.installed = true;
+  p.tx = (cfg->mode & I2S_MODE_TX) != 0;
+  p.rate = cfg->sample_rate;
+  p.bytesPerFrame = cfg->bits_per_sample / 8;
+  p.dmaFrames = (size_t)cfg->dma_buf_len;
+  p.capacity = (size_t)cfg->dma_buf_count * cfg->dma_buf_len;
+  p.startUs = sim::nowUs();
+  if (p.tx) gSpeaker.rate = p.rate;
+  return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+  Port* p = portFor(port);
+  if (!p) return ESP_FAIL;
+  *p = Port();
+  return ESP_OK;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t*) {
+  return portFor(port) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t i2s_set_clk(i2s_port_t port, uint32_t rate, i2s_bits_per_sample_t bits, i2s_channel_t) {
+  Port* p = portFor(port);
+  if (!p) return ESP_FAIL;
+  sim::detail::i2sAdvance(sim::nowUs());
+  p->rate = rate;
+  p->bytesPerFrame = bits / 8;
+  p->startUs = sim::nowUs();
+  p->clocked = 0;
+  if (p->tx) gSpeaker.rate = rate;
+  return ESP_OK;
+}
+
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port) {
+  Port* p = portFor(port);
+  if (!p) return ESP_FAIL;
+  p->queue.clear();
+  return ESP_OK;
+}
+
+// Blocks a descriptor at a time, like the driver: it waits until a whole
+// DMA buffer (or the rest of the request, if smaller) has room.
+esp_err_t i2s_write(i2s_port_t port, const void* src, size_t size, size_t* written,
+                    TickType_t ticks) {
+  *written = 0;
+  Port* p = portFor(port);
+  if (!p || !p->tx || p->bytesPerFrame != 2) return ESP_FAIL;
+  const int16_t* in = static_cast<const int16_t*>(src);
+  size_t frames = size / 2;
+  size_t done = 0;
+  uint64_t deadline = deadlineFor(ticks);
+  while (done < frames) {
+    size_t want = frames - done;
+    if (want > p->dmaFrames) want = p->dmaFrames;
+    std::function<bool()> room = [p, want] { return p->capacity - p->queue.size() >= want; };
+    if (!sim::detail::waitUntil(room, deadline)) break;
+    for (size_t i = 0; i < want; ++i) p->queue.push_back(in[done + i]);
+    done += want;
+  }
+  *written = done * 2;
+  return ESP_OK;
+}
+
+esp_err_t i2s_read(i2s_port_t port, void* dst, size_t size, size_t* read, TickType_t ticks) {
+  *read = 0;
+  Port* p = portFor(port);
+  if (!p || p->tx || p->bytesPerFrame != 4) return ESP_FAIL;
+  int32_t* out = static_cast<int32_t*>(dst);
+  size_t frames = size / 4;
+  size_t done = 0;
+  uint64_t deadline = deadlineFor(ticks);
+  while (done < frames) {
+    size_t want = frames - done;
+    if (want > p->dmaFrames) want = p->dmaFrames;
+    std::function<bool()> filled = [p, want] { return p->queue.size() >= want; };
+    if (!sim::detail::waitUntil(filled, deadline)) break;
+    for (size_t i = 0; i < want; ++i) {
+      out[done + i] = p->queue.front();
+      p->queue.pop_front();
+    }
+    done += want;
+  }
+  *read = done * 4;
+  return ESP_OK;
+}
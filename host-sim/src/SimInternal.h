@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+// Glue between the simulated peripherals; not visible to the firmware.
+namespace sim {
+namespace detail {
+
+static const uint64_t kForever = UINT64_MAX;
+
+// Suspends the caller until ready() holds or the sim clock reaches
+// deadlineUs; returns ready(). Inside a task this yields to the scheduler.
+// In the main context it runs tasks and advances the clock itself.
+bool waitUntil(const std::function<bool()>& ready, uint64_t deadlineUs = kForever);
+bool inTask();
+
+// Peripheral hooks run after every clock step.
+void i2sAdvance(uint64_t nowUs);
+
+}  // namespace detail
+}  // namespace sim
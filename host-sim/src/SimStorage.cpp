@@ -0,0 +1,252 @@
+// LittleFS over a host directory, the assets flash partition and the ROM
+// CRC.
+
+#include <LittleFS.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "Sim.h"
+
+LittleFSFS LittleFS;
+
+namespace {
+
+// Matches the spiffs partition in brickphone-fw/partitions.csv.
+const size_t kFsPartitionBytes = 0x8E0000;
+const size_t kFsBlockBytes = 4096;
+
+std::string gFsRoot = "sim-littlefs";
+
+std::string baseName(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool isDir(const std::string& host) {
+  struct stat st;
+  return stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+size_t usedUnder(const std::string& host) {
+  DIR* d = opendir(host.c_str());
+  if (!d) return 0;
+  size_t used = kFsBlockBytes;   // the directory's own block
+  while (dirent* e = readdir(d)) {
+    if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+    std::string child = host + "/" + e->d_name;
+    struct stat st;
+    if (stat(child.c_str(), &st) != 0) continue;
+    if (S_ISDIR(st.st_mode)) {
+      used += usedUnder(child);
+    } else {
+      used += ((size_t)st.st_size + kFsBlockBytes - 1) / kFsBlockBytes * kFsBlockBytes;
+    }
+  }
+  closedir(d);
+  return used;
+}
+
+}  // namespace
+
+namespace fs {
+
+struct FileImpl {
+  std::string path;   // path inside the filesystem
+  std::string host;
+  std::string name;
+  FILE* fp = nullptr;
+  DIR* dir = nullptr;
+
+  ~FileImpl() {
+    if (fp) fclose(fp);
+    if (dir) closedir(dir);
+  }
+};
+
+size_t File::write(const uint8_t* data, size_t len) {
+  if (!impl || !impl->fp) return 0;
+  return fwrite(data, 1, len, impl->fp);
+}
+
+size_t File::read(uint8_t* dst, size_t len) {
+  if (!impl || !impl->fp) return 0;
+  return fread(dst, 1, len, impl->fp);
+}
+
+int File::available() {
+  if (!impl || !impl->fp) return 0;
+  return (int)(size() - position());
+}
+
+bool File::seek(uint32_t pos) {
+  if (!impl || !impl->fp) return false;
+  return fseek(impl->fp, (long)pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  if (!impl || !impl->fp) return 0;
+  long pos = ftell(impl->fp);
+  return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+  if (!impl || !impl->fp) return 0;
+  fflush(impl->fp);
+  struct stat st;
+  return fstat(fileno(impl->fp), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::flush() {
+  if (impl && impl->fp) fflush(impl->fp);
+}
+
+void File::close() { impl.reset(); }
+
+const char* File::name() const { return impl ? impl->name.c_str() : ""; }
+const char* File::path() const { return impl ? impl->path.c_str() : ""; }
+
+bool File::isDirectory() { return impl && impl->dir; }
+
+File File::openNextFile() {
+  if (!impl || !impl->dir) return File();
+  while (dirent* e = readdir(impl->dir)) {
+    if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+    std::string child = impl->path;
+    if (child.empty() || child.back() != '/') child += "/";
+    child += e->d_name;
+    return LittleFS.open(child.c_str(), FILE_READ);
+  }
+  return File();
+}
+
+File::operator bool() const { return impl && (impl->fp || impl->dir); }
+
+std::string FS::hostPath(const char* path) const {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return (root.empty() ? gFsRoot : root) + p;
+}
+
+File FS::open(const char* path, const char* mode) {
+  std::shared_ptr<FileImpl> f = std::make_shared<FileImpl>();
+  f->path = path ? path : "/";
+  f->host = hostPath(path);
+  f->name = baseName(f->path);
+  if (isDir(f->host)) {
+    if (mode[0] != 'r') return File();
+    f->dir = opendir(f->host.c_str());
+    return f->dir ? File(f) : File();
+  }
+  // "w" opens read/write so the recorder can seek back and patch its header.
+  const char* hostMode = mode[0] == 'w' ? "wb+" : mode[0] == 'a' ? "ab+" : "rb";
+  f->fp = fopen(f->host.c_str(), hostMode);
+  return f->fp ? File(f) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) { return unlink(hostPath(path).c_str()) == 0; }
+
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+bool FS::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+}  // namespace fs
+
+bool LittleFSFS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+  root = gFsRoot;
+  if (isDir(root)) return true;
+  return formatOnFail && ::mkdir(root.c_str(), 0755) == 0;
+}
+
+size_t LittleFSFS::totalBytes() { return kFsPartitionBytes; }
+
+size_t LittleFSFS::usedBytes() {
+  size_t used = usedUnder(root.empty() ? gFsRoot : root);
+  return used < kFsPartitionBytes ? used : kFsPartitionBytes;
+}
+
+// ---------------------------------------------------------------------------
+// Flash partitions: only "assets", erased (0xFF) unless an image is loaded.
+
+namespace {
+
+esp_partition_t gAssetsPart = {
+  ESP_PARTITION_TYPE_DATA, 0x40, 0xEF0000, 0x100000, "assets"
+};
+std::vector<uint8_t> gAssetsFlash;
+
+void eraseAssets() {
+  if (gAssetsFlash.empty()) gAssetsFlash.assign(gAssetsPart.size, 0xFF);
+}
+
+}  // namespace
+
+namespace sim {
+
+void setFsRoot(const char* dir) { gFsRoot = dir; }
+
+bool loadAssetImage(const char* path) {
+  FILE* fp = fopen(path, "rb");
+  if (!fp) return false;
+  gAssetsFlash.assign(gAssetsPart.size, 0xFF);
+  size_t n = fread(gAssetsFlash.data(), 1, gAssetsFlash.size(), fp);
+  bool tooBig = fgetc(fp) != EOF;
+  fclose(fp);
+  return n > 0 && !tooBig;
+}
+
+}  // namespace sim
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label) {
+  if (type != gAssetsPart.type) return nullptr;
+  if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != gAssetsPart.subtype) return nullptr;
+  if (label && strcmp(label, gAssetsPart.label) != 0) return nullptr;
+  return &gAssetsPart;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size) {
+  if (part != &gAssetsPart || offset > part->size || size > part->size - offset) return ESP_FAIL;
+  eraseAssets();
+  memcpy(dst, gAssetsFlash.data() + offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* part, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t, const void** outPtr,
+                             esp_partition_mmap_handle_t* outHandle) {
+  if (part != &gAssetsPart || offset > part->size || size > part->size - offset) return ESP_FAIL;
+  eraseAssets();
+  *outPtr = gAssetsFlash.data() + offset;
+  *outHandle = 1;
+  return ESP_OK;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t) {}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+  static uint32_t table[256];
+  if (!table[1]) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+  }
+  crc = ~crc;
+  for (uint32_t i = 0; i < len; ++i) crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
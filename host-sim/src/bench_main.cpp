@@ -0,0 +1,267 @@
+// brickphone-bench: replays scripted input into each app and checks every
+// rendered frame against golden hashes, timing the screen tick and render
+// paths along the way. Exits non-zero when any frame hash drifts.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "DisplayService.h"
+#include "InputScript.h"
+#include "InputService.h"
+#include "ScreenManager.h"
+#include "ScreenNames.h"
+#include "Sim.h"
+
+void setup();
+extern InputService input;
+extern DisplayService display;
+extern ScreenManager screens;
+
+namespace {
+
+// Same pacing as loop(): a tick every millisecond, a frame every 33.
+const unsigned long kFrameMs = 33;
+
+struct Case {
+  std::string name;
+  std::string screen;
+  double seconds;
+  std::string script;
+};
+
+struct Result {
+  bool ok;
+  char error[160];
+  uint32_t frames;
+  uint64_t ticks;
+  uint64_t hash;
+  double tickSec;
+  double renderSec;
+  double wallSec;
+};
+
+struct Golden {
+  uint32_t frames;
+  uint64_t hash;
+};
+
+const char kUsage[] =
+  "usage: brickphone-bench [options]\n"
+  "  --suite FILE     cases to run (default " BENCH_DIR "/suite.txt)\n"
+  "  --golden FILE    expected frame hashes (default " BENCH_DIR "/golden.txt)\n"
+  "  --only NAME      run one case\n"
+  "  --update         rewrite the golden file from this run\n";
+
+// FNV-1a over each frame, chained, so any changed pixel in any frame
+// changes the result.
+uint64_t hashFrame(uint64_t h, const uint8_t* frame, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    h ^= frame[i];
+    h *= 0x100000001B3ull;
+  }
+  return h;
+}
+
+double since(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+std::string dirOf(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+bool loadSuite(const std::string& path, std::vector<Case>* out) {
+  FILE* fp = fopen(path.c_str(), "r");
+  if (!fp) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), fp)) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    char name[64], screen[32], script[128];
+    double seconds;
+    if (sscanf(line, "%63s %31s %lf %127s", name, screen, &seconds, script) != 4) continue;
+    std::string scriptPath = script[0] == '/' ? script : dirOf(path) + "/" + script;
+    out->push_back({ name, screen, seconds, scriptPath });
+  }
+  fclose(fp);
+  return true;
+}
+
+std::map<std::string, Golden> loadGolden(const std::string& path) {
+  std::map<std::string, Golden> golden;
+  FILE* fp = fopen(path.c_str(), "r");
+  if (!fp) return golden;
+  char line[256];
+  while (fgets(line, sizeof(line), fp)) {
+    if (line[0] == '#') continue;
+    char name[64];
+    unsigned frames;
+    unsigned long long hash;
+    if (sscanf(line, "%63s %u %llx", name, &frames, &hash) == 3) {
+      golden[name] = Golden{ frames, (uint64_t)hash };
+    }
+  }
+  fclose(fp);
+  return golden;
+}
+
+// Runs in a fresh child process, so every case boots the firmware from
+// power-on state regardless of what ran before it.
+Result runCase(const Case& c) {
+  Result r = {};
+  ScreenId id;
+  if (!screenByName(c.screen.c_str(), &id)) {
+    snprintf(r.error, sizeof(r.error), "unknown screen \"%s\"", c.screen.c_str());
+    return r;
+  }
+  InputScript script;
+  std::string error;
+  if (!script.load(c.script.c_str(), &error)) {
+    snprintf(r.error, sizeof(r.error), "%s", error.c_str());
+    return r;
+  }
+  sim::setSeed(script.hasSeed() ? script.seed() : 1);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  screens.set(id);
+
+  uint64_t hash = 0xCBF29CE484222325ull;
+  unsigned long runMs = (unsigned long)(c.seconds * 1000);
+  unsigned long lastMs = millis();
+  script.start();
+  for (unsigned long ms = 0; ms < runMs; ++ms) {
+    unsigned long now = millis();
+    input.poll(now);
+
+    auto t = std::chrono::steady_clock::now();
+    screens.tick(now - lastMs, input);
+    r.tickSec += since(t);
+    r.ticks++;
+    lastMs = now;
+
+    if (ms % kFrameMs == 0) {
+      display.beginFrame();
+      t = std::chrono::steady_clock::now();
+      screens.render(display);
+      r.renderSec += since(t);
+      hash = hashFrame(hash, display.frameBuffer(), DisplayService::kFrameBytes);
+      r.frames++;
+      display.endFrame();
+    }
+    sim::advanceUs(1000);
+  }
+  r.wallSec = since(wallStart);
+  r.hash = hash;
+  r.ok = true;
+  return r;
+}
+
+Result runIsolated(const Case& c) {
+  Result r = {};
+  int fds[2];
+  if (pipe(fds) != 0) {
+    snprintf(r.error, sizeof(r.error), "pipe failed");
+    return r;
+  }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    Result child = runCase(c);
+    ssize_t n = write(fds[1], &child, sizeof(child));
+    _exit(n == (ssize_t)sizeof(child) ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t n = pid > 0 ? read(fds[0], &r, sizeof(r)) : -1;
+  close(fds[0]);
+  int status = 0;
+  if (pid > 0) waitpid(pid, &status, 0);
+  if (n != (ssize_t)sizeof(r)) {
+    r = Result{};
+    snprintf(r.error, sizeof(r.error), "case crashed (status %d)", status);
+  }
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string suitePath = BENCH_DIR "/suite.txt";
+  std::string goldenPath = BENCH_DIR "/golden.txt";
+  const char* only = nullptr;
+  bool update = false;
+  for (int i = 1; i < argc; ++i) {
+    const char* val = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(argv[i], "--suite") && val) suitePath = argv[++i];
+    else if (!strcmp(argv[i], "--golden") && val) goldenPath = argv[++i];
+    else if (!strcmp(argv[i], "--only") && val) only = argv[++i];
+    else if (!strcmp(argv[i], "--update")) update = true;
+    else {
+      fputs(kUsage, stderr);
+      return 2;
+    }
+  }
+
+  std::vector<Case> cases;
+  if (!loadSuite(suitePath, &cases) || cases.empty()) {
+    fprintf(stderr, "no cases in %s\n", suitePath.c_str());
+    return 2;
+  }
+  std::map<std::string, Golden> golden = loadGolden(goldenPath);
+  std::map<std::string, Golden> fresh = golden;
+
+  printf("%-10s %7s %11s %12s %9s  %-16s %s\n", "case", "frames", "ticks/s", "render us/fr",
+         "sim x", "frame hash", "result");
+  int failures = 0;
+  for (const Case& c : cases) {
+    if (only && c.name != only) continue;
+    Result r = runIsolated(c);
+    if (!r.ok) {
+      printf("%-10s %s\n", c.name.c_str(), r.error);
+      failures++;
+      continue;
+    }
+    const char* verdict = "ok";
+    auto it = golden.find(c.name);
+    if (update) {
+      verdict = "updated";
+      fresh[c.name] = Golden{ r.frames, r.hash };
+    } else if (it == golden.end()) {
+      verdict = "NO GOLDEN";
+      failures++;
+    } else if (it->second.frames != r.frames || it->second.hash != r.hash) {
+      verdict = "DRIFT";
+      failures++;
+    }
+    printf("%-10s %7u %11.0f %12.1f %9.0f  %016llx %s\n", c.name.c_str(), r.frames,
+           r.tickSec > 0 ? r.ticks / r.tickSec : 0.0,
+           r.frames ? r.renderSec * 1e6 / r.frames : 0.0,
+           r.wallSec > 0 ? c.seconds / r.wallSec : 0.0, (unsigned long long)r.hash, verdict);
+  }
+
+  if (update) {
+    FILE* fp = fopen(goldenPath.c_str(), "w");
+    if (!fp) {
+      fprintf(stderr, "cannot write %s\n", goldenPath.c_str());
+      return 1;
+    }
+    fprintf(fp, "# Generated by brickphone-bench --update: case, frames, chained FNV-1a of\n"
+                "# every rendered frame.\n");
+    for (const auto& g : fresh) {
+      fprintf(fp, "%s %u %016llx\n", g.first.c_str(), g.second.frames,
+              (unsigned long long)g.second.hash);
+    }
+    fclose(fp);
+  }
+  if (failures) printf("%d case(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
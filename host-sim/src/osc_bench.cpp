@@ -0,0 +1,198 @@
+// osc-bench: times AudioOutService's wavetable oscillator against the
+// per-sample powf()/sinf() synth it replaced, on a 20% volume beep, and
+// checks the table sine against an exact one.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "AudioOutService.h"
+#include "Pins.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t cycles() { return __rdtsc(); }
+#define HAVE_CYCLES 1
+#else
+static inline uint64_t cycles() { return 0; }
+#define HAVE_CYCLES 0
+#endif
+
+namespace {
+
+const int kMidi = 81;
+const int kNoteMs = 1000;
+const int kReps = 50;
+const float kVolume = 0.2f;
+const int kMaxAmp = 16000;  // AudioOutService's MAX_AMP
+
+// The synth as it was before the wavetable: one powf() and one sinf() per
+// sample and the envelope bounds recomputed every sample.
+struct LegacyVoice {
+  int midi;
+  int noteTotalSamples;
+  int noteSamplesLeft;
+  float phase;
+  bool active;
+};
+
+float midiToHz(int midi) {
+  return 440.0f * powf(2.0f, (midi - 69) / 12.0f);
+}
+
+void legacyStart(LegacyVoice& v, int midi, int ms) {
+  v.midi = midi;
+  v.noteTotalSamples = (int)((ms / 1000.0f) * AUDIO_SAMPLE_RATE);
+  if (v.noteTotalSamples < 1) v.noteTotalSamples = 1;
+  v.noteSamplesLeft = v.noteTotalSamples;
+  v.phase = 0.0f;
+  v.active = true;
+}
+
+void legacyMix(LegacyVoice& v, int32_t* acc, int frames) {
+  float amp = kVolume * kMaxAmp;
+  for (int i = 0; i < frames && v.active; ++i) {
+    if (v.noteSamplesLeft > 0) {
+      float freq = midiToHz(v.midi);
+      int sampleIndex = v.noteTotalSamples - v.noteSamplesLeft;
+      float env = 1.0f;
+      int attack = v.noteTotalSamples / 12;
+      int release = v.noteTotalSamples / 8;
+      if (attack < 1) attack = 1;
+      if (release < 1) release = 1;
+      if (sampleIndex < attack) env = (float)sampleIndex / (float)attack;
+      else if (v.noteSamplesLeft < release) env = (float)v.noteSamplesLeft / (float)release;
+
+      v.phase += 2.0f * (float)M_PI * freq / (float)AUDIO_SAMPLE_RATE;
+      if (v.phase > 2.0f * (float)M_PI) v.phase -= 2.0f * (float)M_PI;
+
+      acc[i] += (int32_t)(sinf(v.phase) * env * amp);
+      v.noteSamplesLeft--;
+    }
+    if (v.noteSamplesLeft <= 0) v.active = false;
+  }
+}
+
+struct Timing {
+  double ns;
+  double cycles;
+};
+
+}  // namespace
+
+// Reaches into AudioOutService (it is a friend) so the timed loop is the
+// firmware's own mixSynth().
+class OscBench {
+public:
+  OscBench() {
+    AudioOutService::buildTables();
+    out.setVolume(kVolume);
+  }
+
+  void start(Waveform wave) {
+    AudioOutService::Command cmd = {};
+    cmd.type = AudioOutService::CMD_START;
+    cmd.len = 1;
+    cmd.gainQ15 = 32767;
+    cmd.wave = wave;
+    cmd.single = { kMidi, kNoteMs };
+    out.startVoice(cmd);
+  }
+
+  // Renders the note block by block into `pcm`; returns the sample count.
+  int render(Waveform wave, int32_t* pcm) {
+    start(wave);
+    AudioOutService::Voice& v = out.voices[0];
+    int n = 0;
+    while (v.active) {
+      memset(pcm + n, 0, AUDIO_FRAMES * sizeof(int32_t));
+      out.mixSynth(v, pcm + n, AUDIO_FRAMES);
+      n += AUDIO_FRAMES;
+    }
+    return n;
+  }
+
+private:
+  AudioOutService out;
+};
+
+// Largest error against a double-precision sine with the same envelope.
+// The table is read without interpolation, so the bound is one table
+// step of phase at full amplitude, plus a little envelope rounding.
+static int32_t maxError(const int32_t* pcm, int n) {
+  const double amp = (int32_t)(kVolume * kMaxAmp);
+  const double w = 2.0 * M_PI * midiToHz(kMidi) / AUDIO_SAMPLE_RATE;
+  const int total = kNoteMs * AUDIO_SAMPLE_RATE / 1000;
+  const int attack = total / 12;
+  const int release = total / 8;
+  int32_t worst = 0;
+  for (int i = 0; i < n && i < total; ++i) {
+    double env = 1.0;
+    if (i < attack) env = (double)i / attack;
+    else if (total - i <= release) env = (double)(total - i) / release;
+    int32_t d = abs(pcm[i] - (int32_t)lrint(sin(w * i) * env * amp));
+    if (d > worst) worst = d;
+  }
+  return worst;
+}
+
+static int renderLegacy(int32_t* pcm) {
+  LegacyVoice v;
+  legacyStart(v, kMidi, kNoteMs);
+  int n = 0;
+  while (v.active) {
+    memset(pcm + n, 0, AUDIO_FRAMES * sizeof(int32_t));
+    legacyMix(v, pcm + n, AUDIO_FRAMES);
+    n += AUDIO_FRAMES;
+  }
+  return n;
+}
+
+template <typename F>
+static Timing timePerSample(F render) {
+  int samples = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  uint64_t c0 = cycles();
+  for (int r = 0; r < kReps; ++r) samples += render();
+  uint64_t c1 = cycles();
+  std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+  return { dt.count() / samples, (double)(c1 - c0) / samples };
+}
+
+static void report(const char* name, Timing t, double baseNs) {
+#if HAVE_CYCLES
+  printf("%-16s %10.2f %14.1f %8.1fx\n", name, t.ns, t.cycles, baseNs / t.ns);
+#else
+  printf("%-16s %10.2f %14s %8.1fx\n", name, t.ns, "-", baseNs / t.ns);
+#endif
+}
+
+int main() {
+  // Rendering runs in whole blocks, so leave room for the last one.
+  const int capacity = (kNoteMs * AUDIO_SAMPLE_RATE / 1000 / AUDIO_FRAMES + 2) * AUDIO_FRAMES;
+  int32_t* legacyPcm = (int32_t*)calloc(capacity, sizeof(int32_t));
+  int32_t* pcm = (int32_t*)calloc(capacity, sizeof(int32_t));
+  OscBench osc;
+
+  int32_t err = maxError(pcm, osc.render(WAVE_SINE, pcm));
+  int32_t limit = (int32_t)(kVolume * kMaxAmp * 2.0 * M_PI / 1024) + 4;
+
+  printf("%d ms note, MIDI %d, volume %.0f%%, %d-frame blocks\n",
+         kNoteMs, kMidi, kVolume * 100.0f, AUDIO_FRAMES);
+#if HAVE_CYCLES
+  printf("%-16s %10s %14s %9s\n", "path", "ns/sample", "TSC cyc/sample", "speedup");
+#else
+  printf("%-16s %10s %14s %9s\n", "path", "ns/sample", "cyc/sample", "speedup");
+#endif
+  Timing before = timePerSample([&] { return renderLegacy(legacyPcm); });
+  report("float (before)", before, before.ns);
+  report("sine table", timePerSample([&] { return osc.render(WAVE_SINE, pcm); }), before.ns);
+  report("square", timePerSample([&] { return osc.render(WAVE_SQUARE, pcm); }), before.ns);
+  report("triangle", timePerSample([&] { return osc.render(WAVE_TRIANGLE, pcm); }), before.ns);
+  printf("sine table vs exact: max |error| %d (limit %d)\n", (int)err, (int)limit);
+
+  free(legacyPcm);
+  free(pcm);
+  return err <= limit ? 0 : 1;
+}
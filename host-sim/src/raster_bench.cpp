@@ -0,0 +1,108 @@
+// raster-bench: times the Raster1bpp kernels against the per-pixel
+// Adafruit_GFX path they replaced, on the shapes the games actually draw,
+// and checks both paths leave identical framebuffers.
+
+#include <Adafruit_SSD1306.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "Raster1bpp.h"
+
+namespace {
+
+const int kFrameBytes = 128 * 64 / 8;
+const int kIters = 20000;
+
+// Adafruit_SSD1306 drawing into a caller buffer, so no bus is involved.
+class Canvas : public Adafruit_SSD1306 {
+public:
+  explicit Canvas(uint8_t* fb) : Adafruit_SSD1306(128, 64) { buffer = fb; }
+};
+
+const uint8_t kInvader[8] = {
+  0x18, 0x3C, 0x7E, 0xDB, 0xFF, 0x24, 0x5A, 0xA5
+};
+
+// Breakout's wall: 4x8 bricks of 12x4 at y = 8 + 6r, so most straddle a
+// page boundary.
+void wallGfx(Canvas& c) {
+  for (int r = 0; r < 4; ++r)
+    for (int col = 0; col < 8; ++col) c.fillRect(4 + col * 14, 8 + r * 6, 12, 4, SSD1306_WHITE);
+}
+void wallRaster(uint8_t* fb) {
+  for (int r = 0; r < 4; ++r)
+    for (int col = 0; col < 8; ++col) Raster1bpp::fillRect(fb, 4 + col * 14, 8 + r * 6, 12, 4);
+}
+
+// Space Invaders' swarm: 4x8 8x8 sprites on an odd y.
+void swarmGfx(Canvas& c) {
+  for (int r = 0; r < 4; ++r)
+    for (int col = 0; col < 8; ++col)
+      c.drawBitmap(3 + col * 12, 5 + r * 10, kInvader, 8, 8, SSD1306_WHITE);
+}
+void swarmRaster(uint8_t* fb) {
+  for (int r = 0; r < 4; ++r)
+    for (int col = 0; col < 8; ++col)
+      Raster1bpp::drawBitmap(fb, 3 + col * 12, 5 + r * 10, kInvader, 8, 8);
+}
+
+// Menu selection bar and frame.
+void panelGfx(Canvas& c) {
+  c.fillRect(0, 13, 128, 11, SSD1306_WHITE);
+  c.drawRect(0, 0, 128, 64, SSD1306_WHITE);
+}
+void panelRaster(uint8_t* fb) {
+  Raster1bpp::fillRect(fb, 0, 13, 128, 11);
+  Raster1bpp::drawRect(fb, 0, 0, 128, 64);
+}
+
+struct Case {
+  const char* name;
+  void (*gfx)(Canvas&);
+  void (*raster)(uint8_t*);
+};
+
+const Case kCases[] = {
+  { "wall", wallGfx, wallRaster },
+  { "swarm", swarmGfx, swarmRaster },
+  { "panel", panelGfx, panelRaster },
+};
+
+template <typename F>
+double nsPerIter(F draw) {
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIters; ++i) draw();
+  std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+  return dt.count() / kIters;
+}
+
+}  // namespace
+
+int main() {
+  alignas(4) static uint8_t gfxFb[kFrameBytes];
+  alignas(4) static uint8_t rasterFb[kFrameBytes];
+  Canvas canvas(gfxFb);
+  int failures = 0;
+
+  printf("%-8s %12s %12s %8s\n", "case", "gfx ns", "raster ns", "speedup");
+  for (const Case& c : kCases) {
+    memset(gfxFb, 0, sizeof(gfxFb));
+    memset(rasterFb, 0, sizeof(rasterFb));
+    c.gfx(canvas);
+    c.raster(rasterFb);
+    bool same = memcmp(gfxFb, rasterFb, kFrameBytes) == 0;
+    if (!same) ++failures;
+
+    double gfxNs = nsPerIter([&] {
+      memset(gfxFb, 0, sizeof(gfxFb));
+      c.gfx(canvas);
+    });
+    double rasterNs = nsPerIter([&] {
+      memset(rasterFb, 0, sizeof(rasterFb));
+      c.raster(rasterFb);
+    });
+    printf("%-8s %12.0f %12.0f %7.1fx%s\n", c.name, gfxNs, rasterNs, gfxNs / rasterNs,
+           same ? "" : "  MISMATCH");
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+// resampler-bench: Resampler throughput on 20 ms voice frames in both
+// directions, as ns per output sample and multiples of real time.
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "Resampler.h"
+
+namespace {
+
+const int kSeconds = 60;
+
+struct Case {
+  const char* name;
+  Resampler::Ratio ratio;
+  int inRate;
+  int outRate;
+};
+
+const Case kCases[] = {
+  { "24k -> 16k (uplink)", Resampler::DOWN_3_2, 24000, 16000 },
+  { "16k -> 24k (downlink)", Resampler::UP_2_3, 16000, 24000 },
+};
+
+}  // namespace
+
+int main() {
+  printf("%-22s %12s %12s\n", "ratio", "ns/output", "x realtime");
+  for (const Case& c : kCases) {
+    const int frame = c.inRate / 50;
+    std::vector<int16_t> in(frame);
+    for (int i = 0; i < frame; ++i) in[i] = (int16_t)((i * 7919) % 20000 - 10000);
+
+    Resampler r;
+    r.begin(c.ratio);
+    std::vector<int16_t> out(r.maxOutput(frame));
+    long outputs = 0;
+    volatile int16_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < kSeconds * 50; ++f) {
+      int n = r.process(in.data(), frame, out.data());
+      outputs += n;
+      sink = out[n / 2];
+    }
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+    printf("%-22s %12.2f %12.0f\n", c.name, dt.count() * 1e9 / outputs, kSeconds / dt.count());
+    (void)sink;
+  }
+  return 0;
+}
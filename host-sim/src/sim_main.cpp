@@ -0,0 +1,132 @@
+// brickphone-sim: runs the firmware against the simulated board faster than
+// real time. See the "Host Simulator" section of the README.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include "DisplayService.h"
+#include "InputScript.h"
+#include "ScreenManager.h"
+#include "ScreenNames.h"
+#include "Sim.h"
+
+void setup();
+void loop();
+extern ScreenManager screens;
+extern DisplayService display;
+
+namespace {
+
+const char kUsage[] =
+  "usage: brickphone-sim [options]\n"
+  "  --screen NAME    start on NAME instead of the splash (menu, snake, pong,\n"
+  "                   breakout, invaders, 2048, flappy, recorder, voice, settings)\n"
+  "  --seconds N      simulated run length after setup() (default 10)\n"
+  "  --loop-us N      simulated time between loop() calls (default 1000)\n"
+  "  --input FILE     button script: \"<ms> <BUTTON> down|up\" per line, ms\n"
+  "                   counted from the end of setup(); a \"seed <n>\" line\n"
+  "                   overrides --seed (InputRecorder writes this format)\n"
+  "  --mic WAV        16-bit PCM fed to the I2S mic (looped)\n"
+  "  --speaker WAV    write the I2S speaker output here\n"
+  "  --assets FILE    flash this image into the assets partition\n"
+  "  --fs DIR         host directory backing LittleFS (default sim-littlefs)\n"
+  "  --frame FILE     save the final panel contents as a PBM\n"
+  "  --seed N         boot seed for random() (default 1)\n";
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* screenName = nullptr;
+  const char* inputPath = nullptr;
+  const char* micPath = nullptr;
+  const char* speakerPath = nullptr;
+  const char* assetsPath = nullptr;
+  const char* framePath = nullptr;
+  double seconds = 10.0;
+  unsigned long loopUs = 1000;
+  uint32_t seed = 1;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* val = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(arg, "--screen") && val) screenName = val;
+    else if (!strcmp(arg, "--seconds") && val) seconds = atof(val);
+    else if (!strcmp(arg, "--loop-us") && val) loopUs = strtoul(val, nullptr, 10);
+    else if (!strcmp(arg, "--input") && val) inputPath = val;
+    else if (!strcmp(arg, "--mic") && val) micPath = val;
+    else if (!strcmp(arg, "--speaker") && val) speakerPath = val;
+    else if (!strcmp(arg, "--assets") && val) assetsPath = val;
+    else if (!strcmp(arg, "--fs") && val) sim::setFsRoot(val);
+    else if (!strcmp(arg, "--frame") && val) framePath = val;
+    else if (!strcmp(arg, "--seed") && val) seed = (uint32_t)strtoul(val, nullptr, 10);
+    else {
+      fputs(kUsage, stderr);
+      return 2;
+    }
+    i++;
+  }
+  if (loopUs == 0 || seconds <= 0) {
+    fputs(kUsage, stderr);
+    return 2;
+  }
+
+  ScreenId start = ScreenId::Splash;
+  if (screenName && !screenByName(screenName, &start)) {
+    fprintf(stderr, "unknown screen \"%s\"\n", screenName);
+    return 2;
+  }
+
+  InputScript script;
+  std::string error;
+  if (inputPath && !script.load(inputPath, &error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+  if (script.hasSeed()) seed = script.seed();
+  if (micPath && !sim::openMicWav(micPath)) {
+    fprintf(stderr, "cannot read mic WAV %s (16-bit PCM only)\n", micPath);
+    return 1;
+  }
+  if (speakerPath && !sim::openSpeakerWav(speakerPath)) {
+    fprintf(stderr, "cannot write %s\n", speakerPath);
+    return 1;
+  }
+  if (assetsPath && !sim::loadAssetImage(assetsPath)) {
+    fprintf(stderr, "cannot load asset image %s (max 1 MB)\n", assetsPath);
+    return 1;
+  }
+  sim::setSeed(seed);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  if (screenName) screens.set(start);
+
+  script.start();
+  uint64_t endUs = sim::nowUs() + (uint64_t)(seconds * 1e6);
+  uint64_t loops = 0;
+  while (sim::nowUs() < endUs) {
+    loop();
+    sim::advanceUs(loopUs);
+    loops++;
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double simSeconds = (double)sim::nowUs() / 1e6;
+
+  if (framePath && !sim::writePanelPbm(framePath)) {
+    fprintf(stderr, "cannot write %s\n", framePath);
+  }
+  sim::closeAudio();
+
+  printf("sim %.2f s in %.3f s wall (%.0fx), %llu loops\n", simSeconds, wall,
+         wall > 0 ? simSeconds / wall : 0.0, (unsigned long long)loops);
+  printf("panel: %llu bus bytes, %lu frames dropped\n",
+         (unsigned long long)sim::panelBusBytes(), (unsigned long)display.framesDropped());
+  if (speakerPath) {
+    printf("speaker: %llu frames, %llu underrun\n", (unsigned long long)sim::speakerFrames(),
+           (unsigned long long)sim::speakerUnderrunFrames());
+  }
+  return 0;
+}
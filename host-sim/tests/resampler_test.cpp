@@ -0,0 +1,110 @@
+// Resampler: frequency response of both ratios and exact frame sizes.
+// Tones are measured with a DFT bin over a whole number of cycles, after
+// the filter has settled.
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "Resampler.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, double value, double limit) {
+  printf("%-4s %-34s %8.2f (limit %.2f)\n", ok ? "ok" : "FAIL", what, value, limit);
+  if (!ok) ++failures;
+}
+
+// Amplitude of `hz` in `y` sampled at `rate`.
+static double toneLevel(const std::vector<int16_t>& y, int from, int n, double hz, double rate) {
+  double re = 0.0;
+  double im = 0.0;
+  for (int i = 0; i < n; ++i) {
+    double w = 2.0 * M_PI * hz * i / rate;
+    re += y[from + i] * cos(w);
+    im -= y[from + i] * sin(w);
+  }
+  return 2.0 * sqrt(re * re + im * im) / n;
+}
+
+static double dB(double ratio) { return 20.0 * log10(ratio); }
+
+// Streams one second of a `hz` tone through `r` in 20 ms frames and
+// returns the level at `measureHz` relative to the input amplitude.
+static double response(Resampler::Ratio ratio, double hz, double measureHz) {
+  const double inRate = ratio == Resampler::DOWN_3_2 ? 24000.0 : 16000.0;
+  const double outRate = ratio == Resampler::DOWN_3_2 ? 16000.0 : 24000.0;
+  const int frame = (int)(inRate / 50);
+  const double amp = 16000.0;
+
+  Resampler r;
+  r.begin(ratio);
+  std::vector<int16_t> in(frame);
+  std::vector<int16_t> out;
+  std::vector<int16_t> chunk(r.maxOutput(frame));
+  for (int f = 0; f < 50; ++f) {
+    for (int i = 0; i < frame; ++i) {
+      in[i] = (int16_t)lrint(amp * sin(2.0 * M_PI * hz * (f * frame + i) / inRate));
+    }
+    int n = r.process(in.data(), frame, chunk.data());
+    out.insert(out.end(), chunk.begin(), chunk.begin() + n);
+  }
+  // Skip the first 100 ms; measure 0.5 s (whole cycles of any 10 Hz tone).
+  int n = (int)(outRate / 2);
+  return toneLevel(out, (int)(outRate / 10), n, measureHz, outRate) / amp;
+}
+
+static void testPassband(Resampler::Ratio ratio, const char* name) {
+  double worst = 0.0;
+  for (double hz : { 100.0, 300.0, 1000.0, 2000.0, 3000.0, 4000.0, 5000.0, 6000.0 }) {
+    double g = fabs(dB(response(ratio, hz, hz)));
+    if (g > worst) worst = g;
+  }
+  char what[48];
+  snprintf(what, sizeof(what), "%s passband ripple <=6k (dB)", name);
+  check(worst <= 0.3, what, worst, 0.3);
+}
+
+// 24 -> 16: tones above 8 kHz fold to 16k - f.
+static void testAliasing() {
+  double worst = 0.0;
+  for (double hz : { 9000.0, 10000.0, 11000.0, 11900.0 }) {
+    double g = response(Resampler::DOWN_3_2, hz, 16000.0 - hz);
+    if (g > worst) worst = g;
+  }
+  check(-dB(worst) >= 55.0, "3:2 alias rejection >=9k (dB)", -dB(worst), 55.0);
+}
+
+// 16 -> 24: each tone leaves an image at 16k - f.
+static void testImaging() {
+  double worst = 0.0;
+  for (double hz : { 1000.0, 3000.0, 5000.0, 6000.0 }) {
+    double g = response(Resampler::UP_2_3, hz, 16000.0 - hz);
+    if (g > worst) worst = g;
+  }
+  check(-dB(worst) >= 55.0, "2:3 image rejection <=6k (dB)", -dB(worst), 55.0);
+}
+
+// AppVoice relies on 20 ms frames mapping to exactly 20 ms frames.
+static void testFrameSizes() {
+  int16_t in[480] = {};
+  int16_t out[481];
+  Resampler down;
+  Resampler up;
+  down.begin(Resampler::DOWN_3_2);
+  up.begin(Resampler::UP_2_3);
+  int bad = 0;
+  for (int f = 0; f < 100; ++f) {
+    if (down.process(in, 480, out) != 320) ++bad;
+    if (up.process(in, 320, out) != 480) ++bad;
+  }
+  check(bad == 0, "frames off 480<->320", bad, 0);
+}
+
+int main() {
+  testPassband(Resampler::DOWN_3_2, "3:2");
+  testPassband(Resampler::UP_2_3, "2:3");
+  testAliasing();
+  testImaging();
+  testFrameSizes();
+  return failures ? 1 : 0;
+}
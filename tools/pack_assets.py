@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""Builds the Brickphone asset pack flashed to the "assets" partition.
+
+Usage:
+  tools/pack_assets.py assets/manifest.json -o assets.bin \
+      --header brickphone-fw/AssetIds.h
+
+Manifest entries carry a stable numeric id, a NAME (becomes ASSET_<NAME> in
+the generated header) and exactly one source:
+  "bitmap": "file.pbm"   1bpp PBM (P1 or P4), stored row-major, MSB first,
+                         rows padded to whole bytes (Adafruit drawBitmap)
+  "notes": [[midi, ms]]  synth sequence, stored as int32 pairs
+  "pcm": "file.wav"      PCM16 mono WAV at the firmware's 24 kHz
+
+Pack layout (little-endian), matching AssetPack.h:
+  header  "BPAK", u16 version, u16 count, u32 total bytes,
+          u32 CRC-32 of everything after the header
+  entries count x { u16 id, u8 type, u8 reserved, u16 w, u16 h,
+                    u32 offset, u32 size }, sorted by id
+  blobs   4-byte aligned
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+import wave
+import zlib
+
+MAGIC = b"BPAK"
+VERSION = 1
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<HBBHHII")
+
+TYPE_BITMAP = 1
+TYPE_NOTES = 2
+TYPE_PCM16 = 3
+
+SAMPLE_RATE = 24000
+PARTITION_BYTES = 0x100000
+
+
+def fail(msg):
+    sys.exit("pack_assets: " + msg)
+
+
+def pbm_tokens(data):
+    """Splits a PBM header into whitespace-separated tokens, skipping comments."""
+    tokens = []
+    pos = 0
+    while len(tokens) < 3:
+        while pos < len(data) and data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            while pos < len(data) and data[pos:pos + 1] not in (b"\n", b"\r"):
+                pos += 1
+            continue
+        start = pos
+        while pos < len(data) and not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    return tokens, pos + 1
+
+
+def load_pbm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    (magic, w, h), body = pbm_tokens(data)
+    w, h = int(w), int(h)
+    stride = (w + 7) // 8
+    if magic == b"P4":
+        bits = data[body:body + stride * h]
+        if len(bits) != stride * h:
+            fail("%s: truncated P4 data" % path)
+        return bytes(bits), w, h
+    if magic != b"P1":
+        fail("%s: not a PBM (P1/P4) file" % path)
+    pixels = [c for c in data[body:].decode("ascii") if c in "01"]
+    if len(pixels) < w * h:
+        fail("%s: expected %d pixels, found %d" % (path, w * h, len(pixels)))
+    out = bytearray(stride * h)
+    for y in range(h):
+        for x in range(w):
+            if pixels[y * w + x] == "1":
+                out[y * stride + x // 8] |= 0x80 >> (x % 8)
+    return bytes(out), w, h
+
+
+def load_notes(notes, name):
+    if not notes or len(notes) > 255:
+        fail("%s: note sequences hold 1..255 notes" % name)
+    out = bytearray()
+    for midi, ms in notes:
+        if not 0 <= midi <= 127 or ms <= 0:
+            fail("%s: bad note [%d, %d]" % (name, midi, ms))
+        out += struct.pack("<ii", midi, ms)
+    return bytes(out), len(notes), 0
+
+
+def load_wav(path):
+    with wave.open(path, "rb") as w:
+        if w.getnchannels() != 1 or w.getsampwidth() != 2:
+            fail("%s: must be 16-bit mono" % path)
+        if w.getframerate() != SAMPLE_RATE:
+            fail("%s: must be %d Hz (is %d)" % (path, SAMPLE_RATE, w.getframerate()))
+        return w.readframes(w.getnframes()), SAMPLE_RATE, 0
+
+
+def build(manifest_path):
+    with open(manifest_path) as f:
+        manifest = json.load(f)
+    root = os.path.dirname(os.path.abspath(manifest_path))
+
+    items = []
+    seen = set()
+    for a in manifest["assets"]:
+        aid, name = a["id"], a["name"]
+        if not 0 < aid <= 0xFFFF or aid in seen:
+            fail("%s: id %d is out of range or reused" % (name, aid))
+        seen.add(aid)
+        if "bitmap" in a:
+            kind = TYPE_BITMAP
+            blob, w, h = load_pbm(os.path.join(root, a["bitmap"]))
+        elif "notes" in a:
+            kind = TYPE_NOTES
+            blob, w, h = load_notes(a["notes"], name)
+        elif "pcm" in a:
+            kind = TYPE_PCM16
+            blob, w, h = load_wav(os.path.join(root, a["pcm"]))
+        else:
+            fail("%s: needs one of bitmap/notes/pcm" % name)
+        items.append((aid, name, kind, w, h, blob))
+    items.sort(key=lambda item: item[0])
+
+    offset = HEADER.size + ENTRY.size * len(items)
+    table = bytearray()
+    blobs = bytearray()
+    for aid, _, kind, w, h, blob in items:
+        pad = (-offset) % 4
+        blobs += b"\0" * pad
+        offset += pad
+        table += ENTRY.pack(aid, kind, 0, w, h, offset, len(blob))
+        blobs += blob
+        offset += len(blob)
+
+    body = bytes(table + blobs)
+    total = HEADER.size + len(body)
+    if total > PARTITION_BYTES:
+        fail("pack is %d bytes, partition holds %d" % (total, PARTITION_BYTES))
+    header = HEADER.pack(MAGIC, VERSION, len(items), total, zlib.crc32(body) & 0xFFFFFFFF)
+    return header + body, items
+
+
+def write_header(path, items):
+    lines = [
+        "#pragma once",
+        "",
+        "// Generated by tools/pack_assets.py from assets/manifest.json; do not edit.",
+        "",
+        "#include <stdint.h>",
+        "",
+        "enum AssetId : uint16_t {",
+    ]
+    width = max(len(name) for _, name, *_ in items)
+    for aid, name, *_ in items:
+        lines.append("  ASSET_%s = %d," % (name.ljust(width), aid))
+    lines.append("};")
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the Brickphone asset pack.")
+    parser.add_argument("manifest")
+    parser.add_argument("-o", "--output", required=True, help="pack image to write")
+    parser.add_argument("--header", help="also regenerate the AssetId enum header")
+    args = parser.parse_args()
+
+    pack, items = build(args.manifest)
+    with open(args.output, "wb") as f:
+        f.write(pack)
+    if args.header:
+        write_header(args.header, items)
+    print("%s: %d assets, %d bytes" % (args.output, len(items), len(pack)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Prints the firmware profiler's binary reports (SELECT+START until the
+overlay goes away; that mode streams one packet per second over USB CDC).
+
+Usage: tools/profdump.py /dev/cu.usbmodem101
+Needs pyserial. Packet layout matches Profiler::ReportHeader.
+"""
+import struct
+import sys
+
+import serial
+
+MAGIC = b"\x50\x46"   # 0x4650, little-endian
+HEADER = struct.Struct("<HBBIIIIII")
+STAGE = struct.Struct("<IIIII")
+STAGES = ["LOOP", "INPT", "SVC", "HNDL", "FIXD", "TICK", "DRAW", "ENDF"]
+
+
+def packets(port):
+    buf = bytearray()
+    while True:
+        buf += port.read(256)
+        while True:
+            start = buf.find(MAGIC)
+            if start < 0:
+                del buf[:-1]
+                break
+            del buf[:start]
+            if len(buf) < HEADER.size:
+                break
+            version, count = buf[2], buf[3]
+            if version != 1 or count > len(STAGES):
+                del buf[:1]
+                continue
+            size = HEADER.size + count * STAGE.size + 1
+            if len(buf) < size:
+                break
+            check = 0
+            for b in buf[:size - 1]:
+                check ^= b
+            if check != buf[size - 1]:
+                del buf[:1]
+                continue
+            yield bytes(buf[:size])
+            del buf[:size]
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    port = serial.Serial(sys.argv[1], 115200, timeout=1)
+    for pkt in packets(port):
+        _, version, count, uptime, heap, heap_min, psram, psram_min, stack = HEADER.unpack_from(pkt)
+        print("t=%.1fs  heap %dk (low %dk)  psram %dk (low %dk)  loop stack free %d B"
+              % (uptime / 1000.0, heap // 1024, heap_min // 1024, psram // 1024,
+                 psram_min // 1024, stack))
+        print("  stage     count    min    avg    p99    max  (us)")
+        for i in range(count):
+            n, lo, avg, p99, hi = STAGE.unpack_from(pkt, HEADER.size + i * STAGE.size)
+            name = STAGES[i] if i < len(STAGES) else "S%d" % i
+            print("  %-5s %9d %6d %6d %6d %6d" % (name, n, lo, avg, p99, hi))
+
+
+if __name__ == "__main__":
+    main()
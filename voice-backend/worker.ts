@@ -11,8 +11,12 @@ type HelloMsg = {
   auth: string;
   sample_rate: number;
   channels: number;
+  sample_rates?: number[];
+  codecs?: string[];
 };
 
+type Codec = "pcm16" | "ima_adpcm";
+
 type ControlMsg =
   | { type: "start"; mode: "voice" }
   | { type: "stop" }
@@ -20,7 +24,7 @@ type ControlMsg =
   | { type: "ping"; t: number };
 
 type ServerMsg =
-  | { type: "ready"; session_id: string; sample_rate: number }
+  | { type: "ready"; session_id: string; sample_rate: number; codec: Codec }
   | { type: "state"; value: State }
   | { type: "pong"; t: number }
   | { type: "event"; value: "barge_in" }
@@ -30,9 +34,17 @@ type ServerMsg =
 
 const MAGIC = 0xa0b1;
 const VERSION = 1;
+// Device -> server only: v2 adds a 4-byte codec preamble after the header.
+const VERSION_CODEC = 2;
+
+// Preference order when the device offers several.
+const SUPPORTED_CODECS: Codec[] = ["ima_adpcm", "pcm16"];
+const CODEC_ID: Record<number, Codec> = { 0: "pcm16", 1: "ima_adpcm" };
 
-const DEVICE_SAMPLE_RATE = 24000;
-const FRAME_SAMPLES = 480; // 20 ms @ 24kHz
+// OpenAI realtime runs at 24 kHz; 16 kHz sessions are resampled here.
+const OPENAI_SAMPLE_RATE = 24000;
+const SUPPORTED_RATES = [16000, 24000];
+const FRAME_MS = 20;
 
 // Use the realtime model you have enabled
 const OPENAI_MODEL = "gpt-realtime-mini";
@@ -62,6 +74,11 @@ function handleSession(deviceWs: WebSocket, env: Env) {
 
   let sessionId = crypto.randomUUID();
   let clientLastSeq: number | null = null;
+  let uplinkCodec: Codec = "pcm16";
+  let deviceRate = OPENAI_SAMPLE_RATE;
+  let frameSamples = (deviceRate * FRAME_MS) / 1000;
+  let uplinkResampler: PolyphaseResampler | null = null;
+  let downlinkResampler: PolyphaseResampler | null = null;
 
   let serverSeq = 0;
   let sessionStartMs = Date.now();
@@ -73,6 +90,9 @@ function handleSession(deviceWs: WebSocket, env: Env) {
 
   let openaiWs: WebSocket | null = null;
   let openaiReady = false;
+  // Between response.created and response.done; cancelling outside that
+  // window makes OpenAI answer with an error.
+  let responseActive = false;
 
   // Output audio: hold 1 chunk so we never need a zero-sample END frame
   let outUtteranceActive = false;
@@ -98,7 +118,7 @@ function handleSession(deviceWs: WebSocket, env: Env) {
 
   const updateFlow = (samples: number) => {
     const now = Date.now();
-    const ms = (samples / DEVICE_SAMPLE_RATE) * 1000;
+    const ms = (samples / deviceRate) * 1000;
     frameWindow.push({ t: now, ms });
     while (frameWindow.length && now - frameWindow[0].t > 1000) frameWindow.shift();
     const sum = frameWindow.reduce((acc, cur) => acc + cur.ms, 0);
@@ -205,18 +225,29 @@ function handleSession(deviceWs: WebSocket, env: Env) {
         return;
       }
 
+      if (t === "response.created") {
+        responseActive = true;
+        return;
+      }
+
+      if (t === "response.done") {
+        responseActive = false;
+        return;
+      }
+
       // Audio delta event name can vary by snippet/version, accept both
       if (t === "response.output_audio.delta" || t === "response.audio.delta") {
         const b64 = String(msg.delta ?? "");
         const pcmBytes = base64ToBytes(b64);
         if (pcmBytes.length) {
-          const samples = new Int16Array(
+          let samples = new Int16Array(
             pcmBytes.buffer.slice(pcmBytes.byteOffset, pcmBytes.byteOffset + pcmBytes.byteLength)
           );
+          if (downlinkResampler) samples = downlinkResampler.process(samples);
 
           let i = 0;
           while (i < samples.length) {
-            const take = Math.min(FRAME_SAMPLES, samples.length - i);
+            const take = Math.min(frameSamples, samples.length - i);
             const chunk = samples.subarray(i, i + take);
 
             // If we already have a held frame, we now know it is not the end
@@ -276,14 +307,32 @@ function handleSession(deviceWs: WebSocket, env: Env) {
           return sendErrorAndClose("BAD_FORMAT", "invalid hello");
         }
         if (hello.auth !== env.BRICKPHONE_TOKEN) return sendErrorAndClose("AUTH_FAILED", "bad token");
-        if (hello.sample_rate !== DEVICE_SAMPLE_RATE) {
-          return sendErrorAndClose("UNSUPPORTED_RATE", "sample_rate must be 24000");
+        // `sample_rates` lists what the device can do, in preference order;
+        // older firmware only sends `sample_rate`.
+        const rates = Array.isArray(hello.sample_rates) ? hello.sample_rates : [hello.sample_rate];
+        const rate = rates.find((r) => SUPPORTED_RATES.includes(r));
+        if (rate === undefined) {
+          return sendErrorAndClose("UNSUPPORTED_RATE", "sample_rate must be 16000 or 24000");
+        }
+        deviceRate = rate;
+        frameSamples = (deviceRate * FRAME_MS) / 1000;
+        if (deviceRate !== OPENAI_SAMPLE_RATE) {
+          uplinkResampler = new PolyphaseResampler(3, 2);
+          downlinkResampler = new PolyphaseResampler(2, 3);
         }
 
+        const offered = Array.isArray(hello.codecs) ? hello.codecs : [];
+        uplinkCodec = SUPPORTED_CODECS.find((c) => offered.includes(c)) ?? "pcm16";
+
         helloOk = true;
         sessionId = crypto.randomUUID();
         sessionStartMs = Date.now();
-        sendDeviceJson({ type: "ready", session_id: sessionId, sample_rate: DEVICE_SAMPLE_RATE });
+        sendDeviceJson({
+          type: "ready",
+          session_id: sessionId,
+          sample_rate: deviceRate,
+          codec: uplinkCodec,
+        });
 
         connectOpenAI().catch((e) => {
           const em = e instanceof Error ? `${e.name}: ${e.message}` : String(e);
@@ -301,6 +350,7 @@ function handleSession(deviceWs: WebSocket, env: Env) {
 
       if (control.type === "start") {
         setState("listening");
+        uplinkResampler?.reset();
         outUtteranceActive = false;
         heldOutFrame = null;
         if (openaiReady) openaiSend({ type: "input_audio_buffer.clear" });
@@ -330,7 +380,7 @@ function handleSession(deviceWs: WebSocket, env: Env) {
         outUtteranceActive = false;
         heldOutFrame = null;
         if (openaiReady) {
-          openaiSend({ type: "response.cancel" });
+          if (responseActive) openaiSend({ type: "response.cancel" });
           openaiSend({ type: "input_audio_buffer.clear" });
         }
         return;
@@ -352,8 +402,30 @@ function handleSession(deviceWs: WebSocket, env: Env) {
       const seq = view.getUint16(4, true);
       const samples = view.getUint16(6, true);
 
-      const expectedLen = 12 + samples * 2;
-      if (magic !== MAGIC || version !== VERSION || expectedLen !== buf.byteLength) {
+      if (magic !== MAGIC) return sendErrorAndClose("BAD_FORMAT", "invalid frame");
+
+      let pcm: Uint8Array;
+      if (version === VERSION) {
+        if (12 + samples * 2 !== buf.byteLength) {
+          return sendErrorAndClose("BAD_FORMAT", "invalid frame");
+        }
+        pcm = new Uint8Array(buf, 12);
+      } else if (version === VERSION_CODEC && buf.byteLength >= 16) {
+        const codec = CODEC_ID[view.getUint8(12)];
+        if (codec === "pcm16" && 16 + samples * 2 === buf.byteLength) {
+          pcm = new Uint8Array(buf, 16);
+        } else if (codec === "ima_adpcm" && 16 + Math.ceil(samples / 2) === buf.byteLength) {
+          const decoded = decodeImaAdpcm(
+            new Uint8Array(buf, 16),
+            samples,
+            view.getInt16(14, true),
+            view.getUint8(13)
+          );
+          pcm = new Uint8Array(decoded.buffer);
+        } else {
+          return sendErrorAndClose("BAD_FORMAT", "invalid frame");
+        }
+      } else {
         return sendErrorAndClose("BAD_FORMAT", "invalid frame");
       }
 
@@ -368,8 +440,11 @@ function handleSession(deviceWs: WebSocket, env: Env) {
       updateFlow(samples);
 
       if (openaiReady && samples > 0) {
-        const payload = new Uint8Array(buf.slice(12));
-        openaiSend({ type: "input_audio_buffer.append", audio: bytesToBase64(payload) });
+        if (uplinkResampler) {
+          const pcm16 = new Int16Array(pcm.buffer.slice(pcm.byteOffset, pcm.byteOffset + pcm.byteLength));
+          pcm = new Uint8Array(uplinkResampler.process(pcm16).buffer);
+        }
+        openaiSend({ type: "input_audio_buffer.append", audio: bytesToBase64(pcm) });
       }
       return;
     }
@@ -395,6 +470,104 @@ function concatBuffers(a: ArrayBuffer, b: ArrayBuffer) {
   return out.buffer;
 }
 
+const IMA_INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8];
+const IMA_STEP_TABLE = [
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73,
+  80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494,
+  544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499,
+  2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+  12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+];
+
+// IMA/DVI ADPCM, low nibble first; each frame restarts from the predictor
+// and step index in its preamble.
+function decodeImaAdpcm(data: Uint8Array, samples: number, predictor: number, index: number) {
+  const out = new Int16Array(samples);
+  let pred = predictor;
+  let idx = Math.min(Math.max(index, 0), 88);
+  for (let i = 0; i < samples; i++) {
+    const code = (data[i >> 1] >> ((i & 1) * 4)) & 0x0f;
+    const step = IMA_STEP_TABLE[idx];
+    let delta = step >> 3;
+    if (code & 4) delta += step;
+    if (code & 2) delta += step >> 1;
+    if (code & 1) delta += step >> 2;
+    pred = code & 8 ? pred - delta : pred + delta;
+    pred = Math.min(Math.max(pred, -32768), 32767);
+    idx = Math.min(Math.max(idx + IMA_INDEX_TABLE[code], 0), 88);
+    out[i] = pred;
+  }
+  return out;
+}
+
+// Same design as the firmware Resampler: Kaiser-windowed sinc (7 kHz
+// cutoff, beta 5) on the 48 kHz grid shared by 16 and 24 kHz, split into
+// `up` phases of 32 taps. Streams across calls.
+class PolyphaseResampler {
+  private static readonly TAPS_PER_PHASE = 32;
+  private readonly coeffs: Float32Array[] = [];
+  private history = new Float32Array(PolyphaseResampler.TAPS_PER_PHASE - 1);
+  private t = 0;
+
+  constructor(private readonly up: number, private readonly down: number) {
+    const taps = PolyphaseResampler.TAPS_PER_PHASE * up;
+    const center = (taps - 1) / 2;
+    const fc = 7000 / 48000;
+    const beta = 5;
+    const proto = new Float64Array(taps);
+    let sum = 0;
+    for (let n = 0; n < taps; n++) {
+      const x = n - center;
+      const sinc = x === 0 ? 2 * fc : Math.sin(2 * Math.PI * fc * x) / (Math.PI * x);
+      const r = x / center;
+      proto[n] = sinc * (besselI0(beta * Math.sqrt(1 - r * r)) / besselI0(beta));
+      sum += proto[n];
+    }
+    for (let p = 0; p < up; p++) {
+      const phase = new Float32Array(PolyphaseResampler.TAPS_PER_PHASE);
+      for (let j = 0; j < phase.length; j++) phase[j] = (proto[p + j * up] * up) / sum;
+      this.coeffs.push(phase);
+    }
+    this.reset();
+  }
+
+  reset() {
+    this.history.fill(0);
+    this.t = this.history.length * this.up;
+  }
+
+  process(input: Int16Array) {
+    const hist = this.history.length;
+    const work = new Float32Array(hist + input.length);
+    work.set(this.history, 0);
+    for (let i = 0; i < input.length; i++) work[hist + i] = input[i];
+
+    const out: number[] = [];
+    while (Math.floor(this.t / this.up) < work.length) {
+      const i = Math.floor(this.t / this.up);
+      const c = this.coeffs[this.t % this.up];
+      let acc = 0;
+      for (let j = 0; j < c.length; j++) acc += c[j] * work[i - j];
+      out.push(Math.max(-32768, Math.min(32767, Math.round(acc))));
+      this.t += this.down;
+    }
+
+    this.history = work.slice(work.length - hist);
+    this.t -= input.length * this.up;
+    return Int16Array.from(out);
+  }
+}
+
+function besselI0(x: number) {
+  let sum = 1;
+  let term = 1;
+  for (let k = 1; k < 20; k++) {
+    term *= (x / (2 * k)) ** 2;
+    sum += term;
+  }
+  return sum;
+}
+
 function bytesToBase64(bytes: Uint8Array) {
   const chunkSize = 0x8000;
   let binary = "";